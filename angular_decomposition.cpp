@@ -0,0 +1,153 @@
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <iostream>
+#include <cassert>
+#include "angular_decomposition.hpp"
+
+namespace {
+  size_t find_sector(const vector<double>& boundaries, double angle)
+  {
+    return static_cast<size_t>
+      (std::upper_bound(boundaries.begin()+1,
+			boundaries.end()-1,
+			angle) - boundaries.begin() - 1);
+  }
+
+  bool in_halo(const vector<double>& boundaries,
+	       double halo_angle,
+	       size_t sector,
+	       size_t owner,
+	       double angle)
+  {
+    return owner!=sector &&
+      angle>=boundaries[sector]-halo_angle &&
+      angle<boundaries[sector+1]+halo_angle;
+  }
+}
+
+AngularDecomposition::Neighbour::Neighbour(int rank_i):
+  rank(rank_i), send(), receive() {}
+
+AngularDecomposition::AngularDecomposition
+(const vector<Vector2D>& points,
+ const CircularSection& domain,
+ double halo_angle,
+ int rank,
+ int size):
+  rank_(rank),
+  size_(size),
+  boundaries_(),
+  local_points_(),
+  halo_flags_(),
+  neighbours_()
+{
+  if(size<1 || rank<0 || rank>=size)
+    throw "AngularDecomposition: invalid rank";
+  vector<double> angles(points.size());
+  vector<double> live;
+  for(size_t i=0;i<points.size();++i){
+    angles[i] = atan2(points[i].y, points[i].x);
+    if(domain(points[i]))
+      live.push_back(angles[i]);
+  }
+  const size_t n_sectors = static_cast<size_t>(size);
+  if(live.size()<n_sectors)
+    throw "AngularDecomposition: fewer live points than ranks";
+  std::sort(live.begin(), live.end());
+  // Sectors with equal numbers of live points. The outer sectors also
+  // take the ghost points beyond the wedge.
+  boundaries_.push_back(-std::numeric_limits<double>::max());
+  for(size_t k=1;k<n_sectors;++k){
+    const size_t split = k*live.size()/n_sectors;
+    boundaries_.push_back(0.5*(live[split-1]+live[split]));
+  }
+  boundaries_.push_back(std::numeric_limits<double>::max());
+
+  const size_t own = static_cast<size_t>(rank);
+  vector<size_t> owners(points.size());
+  vector<size_t> local_index(points.size(), points.size());
+  for(size_t i=0;i<points.size();++i){
+    owners[i] = find_sector(boundaries_, angles[i]);
+    const bool halo = in_halo(boundaries_, halo_angle, own,
+			      owners[i], angles[i]);
+    if(owners[i]==own || halo){
+      local_index[i] = local_points_.size();
+      local_points_.push_back(points[i]);
+      halo_flags_.push_back(halo ? 1 : 0);
+    }
+  }
+  // Both sides list the shared points in increasing original index
+  for(size_t k=0;k<n_sectors;++k){
+    if(k==own)
+      continue;
+    Neighbour neighbour(static_cast<int>(k));
+    for(size_t i=0;i<points.size();++i){
+      if(owners[i]==own &&
+	 in_halo(boundaries_, halo_angle, k, owners[i], angles[i]))
+	neighbour.send.push_back(local_index[i]);
+      if(owners[i]==k &&
+	 in_halo(boundaries_, halo_angle, own, owners[i], angles[i]))
+	neighbour.receive.push_back(local_index[i]);
+    }
+    if(!neighbour.send.empty() || !neighbour.receive.empty())
+      neighbours_.push_back(neighbour);
+  }
+  if(size>1){
+    const size_t n_halo = static_cast<size_t>
+      (std::count(halo_flags_.begin(), halo_flags_.end(), 1));
+    std::cout << "rank " << rank << ": " << local_points_.size()-n_halo
+	      << " own, " << n_halo << " halo points, "
+	      << neighbours_.size() << " neighbours" << std::endl;
+  }
+}
+
+const vector<Vector2D>& AngularDecomposition::getLocalPoints(void) const
+{
+  return local_points_;
+}
+
+const vector<char>& AngularDecomposition::getHaloFlags(void) const
+{
+  return halo_flags_;
+}
+
+const vector<AngularDecomposition::Neighbour>&
+AngularDecomposition::getNeighbours(void) const
+{
+  return neighbours_;
+}
+
+pair<double,double> AngularDecomposition::getSector(void) const
+{
+  const size_t own = static_cast<size_t>(rank_);
+  return pair<double,double>(boundaries_[own], boundaries_[own+1]);
+}
+
+int AngularDecomposition::getRank(void) const
+{
+  return rank_;
+}
+
+int AngularDecomposition::getSize(void) const
+{
+  return size_;
+}
+
+bool is_halo(const ComputationalCell& cell)
+{
+  const boost::container::flat_map<string,bool>::const_iterator it =
+    cell.stickers.find("halo");
+  return it!=cell.stickers.end() && it->second;
+}
+
+void mark_halo(const AngularDecomposition& decomposition,
+	       vector<ComputationalCell>& cells)
+{
+  if(decomposition.getSize()==1)
+    return;
+  const vector<char>& flags = decomposition.getHaloFlags();
+  assert(flags.size()==cells.size());
+  for(size_t i=0;i<cells.size();++i)
+    cells[i].stickers["halo"] = flags[i]!=0;
+}
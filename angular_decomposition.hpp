@@ -0,0 +1,96 @@
+#ifndef ANGULAR_DECOMPOSITION_HPP
+#define ANGULAR_DECOMPOSITION_HPP 1
+
+#include <vector>
+#include "source/tessellation/geometry.hpp"
+#include "source/newtonian/two_dimensional/computational_cell_2d.hpp"
+#include "circular_section.hpp"
+
+using std::vector;
+using std::pair;
+
+/*! \brief Split of the wedge into angular sectors, one per MPI rank
+  \details Every rank generates the same mesh points, and the sector
+  boundaries are chosen so each sector has the same number of live points.
+  A rank keeps the points of its sector, and the points of other sectors
+  within a halo angle of it. With a halo a few cells wide, the Voronoi
+  cells of the rank's own points, and of their neighbours, are the same as
+  in the undivided mesh, so the fluxes of its own cells are too. Halo cells
+  are not updated locally, and receive their owner's values after every
+  step. No communication is needed to set up the exchange, since every
+  rank derives the same lists from the same points.
+ */
+class AngularDecomposition
+{
+public:
+
+  //! \brief Cells exchanged with one other rank
+  class Neighbour
+  {
+  public:
+
+    explicit Neighbour(int rank_i);
+
+    int rank;
+
+    //! \brief Local indices of own cells in the other rank's halo
+    vector<size_t> send;
+
+    //! \brief Local indices of halo cells owned by the other rank
+    vector<size_t> receive;
+  };
+
+  /*! \brief Class constructor
+    \param points Mesh points of the whole wedge, in the same order on every rank
+    \param domain Wedge of live cells
+    \param halo_angle Width of the halo on either side of a sector, in radians
+    \param rank Rank of this process
+    \param size Number of ranks
+   */
+  AngularDecomposition(const vector<Vector2D>& points,
+		       const CircularSection& domain,
+		       double halo_angle,
+		       int rank,
+		       int size);
+
+  //! \brief Points of this rank, own and halo, in their original order
+  const vector<Vector2D>& getLocalPoints(void) const;
+
+  //! \brief Whether each local point belongs to another rank
+  const vector<char>& getHaloFlags(void) const;
+
+  //! \brief Ranks that share cells with this one, in increasing order
+  const vector<Neighbour>& getNeighbours(void) const;
+
+  //! \brief Angles bounding the sector of this rank
+  pair<double,double> getSector(void) const;
+
+  int getRank(void) const;
+
+  int getSize(void) const;
+
+private:
+  const int rank_;
+  const int size_;
+  vector<double> boundaries_;
+  vector<Vector2D> local_points_;
+  vector<char> halo_flags_;
+  vector<Neighbour> neighbours_;
+};
+
+/*! \brief Checks whether a cell is a copy of a cell owned by another rank
+  \param cell Cell
+  \return True for halo cells, false otherwise, including runs without a halo
+ */
+bool is_halo(const ComputationalCell& cell);
+
+/*! \brief Adds the halo sticker to all cells
+  \details Undivided runs are left without the sticker, so their output
+  does not change
+  \param decomposition Decomposition the mesh was built from
+  \param cells Cells, in the order of the local points
+ */
+void mark_halo(const AngularDecomposition& decomposition,
+	       vector<ComputationalCell>& cells);
+
+#endif // ANGULAR_DECOMPOSITION_HPP
@@ -0,0 +1,195 @@
+#include <cstdio>
+#include <fstream>
+#include "H5Cpp.h"
+#include "async_snapshots.hpp"
+
+AsyncSnapshots::AsyncSnapshots(Trigger* trigger,
+			       FileNameGenerator* fng,
+			       const vector<DiagnosticAppendix*>& appendices,
+			       size_t max_pending,
+			       const SnapshotLayout& layout):
+  trigger_(trigger),
+  fng_(fng),
+  appendices_(appendices),
+  max_pending_(max_pending),
+  layout_(layout),
+  counter_(0),
+  geometry_hash_(),
+  queue_(),
+  writing_(false),
+  stop_(false),
+  error_(),
+  mutex_(),
+  queued_(),
+  written_(),
+  thread_()
+{
+  assert(max_pending_>0);
+  pthread_mutex_init(&mutex_,0);
+  pthread_cond_init(&queued_,0);
+  pthread_cond_init(&written_,0);
+  pthread_create(&thread_,0,&AsyncSnapshots::writerThread,this);
+}
+
+AsyncSnapshots::Job::Job(const string& fname_i,
+			 const string& geometry_file_i,
+			 const string& geometry_hash_i,
+			 bool new_geometry_i,
+			 SnapshotData* data_i):
+  fname(fname_i),
+  geometry_file(geometry_file_i),
+  geometry_hash(geometry_hash_i),
+  new_geometry(new_geometry_i),
+  data(data_i) {}
+
+namespace {
+  string directory_of(const string& fname)
+  {
+    return fname.substr(0,fname.rfind('/')+1);
+  }
+
+  bool file_exists(const string& fname)
+  {
+    return std::ifstream(fname.c_str()).good();
+  }
+}
+
+void* AsyncSnapshots::writerThread(void* self)
+{
+  static_cast<AsyncSnapshots*>(self)->writerLoop();
+  return 0;
+}
+
+void AsyncSnapshots::writerLoop(void)
+{
+  pthread_mutex_lock(&mutex_);
+  while(true){
+    while(queue_.empty() && !stop_)
+      pthread_cond_wait(&queued_,&mutex_);
+    if(queue_.empty())
+      break;
+    const Job job = queue_.front();
+    queue_.pop_front();
+    writing_ = true;
+    pthread_mutex_unlock(&mutex_);
+
+    string error;
+    try{
+      const string geometry_path =
+	directory_of(job.fname) + job.geometry_file;
+      if(job.new_geometry && !file_exists(geometry_path)){
+	const string temp_name = geometry_path + ".tmp";
+	write_geometry(*job.data, temp_name, layout_, job.geometry_hash);
+	if(rename(temp_name.c_str(), geometry_path.c_str())!=0)
+	  error = "failed to rename " + temp_name;
+      }
+      if(error.empty()){
+	const string temp_name = job.fname + ".tmp";
+	write_snapshot(*job.data, temp_name, layout_,
+		       job.geometry_file, job.geometry_hash);
+	if(rename(temp_name.c_str(), job.fname.c_str())!=0)
+	  error = "failed to rename " + temp_name;
+      }
+    }
+    catch(const H5::Exception& e){
+      error = "failed to write " + job.fname + ": " + e.getDetailMsg();
+    }
+    delete job.data;
+
+    pthread_mutex_lock(&mutex_);
+    writing_ = false;
+    if(!error.empty() && error_.empty())
+      error_ = error;
+    pthread_cond_broadcast(&written_);
+  }
+  pthread_mutex_unlock(&mutex_);
+}
+
+void AsyncSnapshots::checkError(void)
+{
+  pthread_mutex_lock(&mutex_);
+  const string error = error_;
+  pthread_mutex_unlock(&mutex_);
+  if(!error.empty())
+    throw error;
+}
+
+void AsyncSnapshots::operator()(const hdsim& sim)
+{
+  checkError();
+  if(!(*trigger_)(sim))
+    return;
+  pthread_mutex_lock(&mutex_);
+  while(queue_.size()+(writing_ ? 1 : 0)>=max_pending_)
+    pthread_cond_wait(&written_,&mutex_);
+  pthread_mutex_unlock(&mutex_);
+
+  SnapshotData* data = new SnapshotData;
+  stage_snapshot(sim, appendices_, *data);
+  const string fname = (*fng_)(counter_);
+  ++counter_;
+  string geometry_file;
+  string hash;
+  bool new_geometry = false;
+  if(layout_.shared_geometry){
+    hash = mesh_hash(*data, layout_.drop_ghosts);
+    geometry_file = "mesh_" + hash + ".h5";
+    if(hash!=geometry_hash_){
+      stage_vertices(sim.getTessellation(), *data);
+      geometry_hash_ = hash;
+      new_geometry = true;
+    }
+  }
+  else
+    stage_vertices(sim.getTessellation(), *data);
+  const Job job(fname, geometry_file, hash, new_geometry, data);
+
+  pthread_mutex_lock(&mutex_);
+  queue_.push_back(job);
+  pthread_cond_signal(&queued_);
+  pthread_mutex_unlock(&mutex_);
+}
+
+void AsyncSnapshots::drain(void)
+{
+  pthread_mutex_lock(&mutex_);
+  while(!queue_.empty() || writing_)
+    pthread_cond_wait(&written_,&mutex_);
+  pthread_mutex_unlock(&mutex_);
+  checkError();
+}
+
+int AsyncSnapshots::getCounter(void) const
+{
+  return counter_;
+}
+
+void AsyncSnapshots::saveState(map<string,double>& state)
+{
+  drain();
+  state["snapshot counter"] = counter_;
+}
+
+void AsyncSnapshots::loadState(const map<string,double>& state)
+{
+  const map<string,double>::const_iterator it =
+    state.find("snapshot counter");
+  assert(it!=state.end());
+  counter_ = static_cast<int>(it->second);
+}
+
+AsyncSnapshots::~AsyncSnapshots(void)
+{
+  pthread_mutex_lock(&mutex_);
+  stop_ = true;
+  pthread_cond_signal(&queued_);
+  pthread_mutex_unlock(&mutex_);
+  pthread_join(thread_,0);
+  pthread_cond_destroy(&written_);
+  pthread_cond_destroy(&queued_);
+  pthread_mutex_destroy(&mutex_);
+  delete trigger_;
+  delete fng_;
+  for(size_t i=0;i<appendices_.size();++i)
+    delete appendices_[i];
+}
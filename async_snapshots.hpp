@@ -0,0 +1,98 @@
+#ifndef ASYNC_SNAPSHOTS_HPP
+#define ASYNC_SNAPSHOTS_HPP 1
+
+#include <deque>
+#include <pthread.h>
+#include "source/newtonian/test_2d/consecutive_snapshots.hpp"
+#include "snapshot_data.hpp"
+#include "checkpoint_state.hpp"
+
+using std::deque;
+
+/*! \brief Snapshots written by a background thread
+  \details The simulation state and appendices are copied into a staging
+  buffer on the calling thread, and the hdf5 output happens on a writer
+  thread. Appendices are evaluated during staging, since the equation of
+  state is not reentrant. With a shared geometry layout, the cell vertices
+  are only staged when the mesh hash changes, and go to a mesh file next to
+  the snapshots that is reused if it already exists. If more than a given number of snapshots are
+  waiting to be written, staging blocks until the writer catches up.
+ */
+class AsyncSnapshots: public DiagnosticFunction, public CheckpointState
+{
+public:
+
+  /*! \brief Class constructor
+    \param trigger Decides when to write a snapshot
+    \param fng File name generator
+    \param appendices Additional fields
+    \param max_pending Maximum number of snapshots waiting for the writer
+    \param layout Compression and field selection
+   */
+  AsyncSnapshots(Trigger* trigger,
+		 FileNameGenerator* fng,
+		 const vector<DiagnosticAppendix*>& appendices,
+		 size_t max_pending,
+		 const SnapshotLayout& layout=SnapshotLayout());
+
+  void operator()(const hdsim& sim);
+
+  //! \brief Blocks until every staged snapshot has been written
+  void drain(void);
+
+  //! \brief Number of snapshots staged so far
+  int getCounter(void) const;
+
+  //! \brief Drains the queue, so every snapshot before the checkpoint is on disk
+  void saveState(map<string,double>& state);
+
+  void loadState(const map<string,double>& state);
+
+  ~AsyncSnapshots(void);
+
+private:
+
+  class Job
+  {
+  public:
+
+    Job(const string& fname_i,
+	const string& geometry_file_i,
+	const string& geometry_hash_i,
+	bool new_geometry_i,
+	SnapshotData* data_i);
+
+    string fname;
+    string geometry_file;
+    string geometry_hash;
+    bool new_geometry;
+    SnapshotData* data;
+  };
+
+  Trigger* const trigger_;
+  FileNameGenerator* const fng_;
+  const vector<DiagnosticAppendix*> appendices_;
+  const size_t max_pending_;
+  const SnapshotLayout layout_;
+  int counter_;
+  string geometry_hash_;
+  deque<Job> queue_;
+  bool writing_;
+  bool stop_;
+  string error_;
+  pthread_mutex_t mutex_;
+  pthread_cond_t queued_;
+  pthread_cond_t written_;
+  pthread_t thread_;
+
+  static void* writerThread(void* self);
+
+  void writerLoop(void);
+
+  void checkError(void);
+
+  AsyncSnapshots(const AsyncSnapshots&);
+  AsyncSnapshots& operator=(const AsyncSnapshots&);
+};
+
+#endif // ASYNC_SNAPSHOTS_HPP
@@ -1,7 +1,8 @@
 #include "atlas_support.hpp"
 #include "safe_retrieve.hpp"
 
-AtlasSupport::AtlasSupport(void) {}
+AtlasSupport::AtlasSupport(PhaseProfiler& prof):
+  prof_(prof), phase_(prof.addPhase("atlas_support")) {}
 
 namespace {
 
@@ -72,6 +73,7 @@ namespace {
 
 void AtlasSupport::operator()(hdsim& sim)
 {
+  const PhaseProfiler::ScopedTimer timer(prof_, phase_);
   const Tessellation& tess = sim.getTessellation();
   const vector<ComputationalCell>& cell_list = sim.getAllCells();
   const vector<size_t> index_list = 
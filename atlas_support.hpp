@@ -2,14 +2,19 @@
 #define ATLAS_SUPPORT 1
 
 #include "source/newtonian/test_2d/main_loop_2d.hpp"
+#include "phase_profiler.hpp"
 
 class AtlasSupport: public Manipulate
 {
 public:
 
-  AtlasSupport(void);
+  explicit AtlasSupport(PhaseProfiler& prof);
 
   void operator()(hdsim& sim);
+
+private:
+  PhaseProfiler& prof_;
+  const size_t phase_;
 };
 
 #endif // ATLAS_SUPPORT
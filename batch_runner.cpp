@@ -0,0 +1,153 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cerrno>
+#include <cassert>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "batch_runner.hpp"
+#include "wall_clock.hpp"
+
+namespace {
+
+  class BatchRun
+  {
+  public:
+
+    BatchRun(const string& directory_i,
+	     const vector<string>& overrides_i):
+      directory(directory_i),
+      overrides(overrides_i),
+      pid(0),
+      start(0) {}
+
+    string directory;
+    vector<string> overrides;
+    pid_t pid;
+    double start;
+  };
+
+  vector<BatchRun> read_batch(const string& fname)
+  {
+    std::ifstream f(fname.c_str());
+    if(!f)
+      throw "failed to open " + fname;
+    vector<BatchRun> res;
+    string line;
+    while(std::getline(f,line)){
+      std::istringstream ss(line.substr(0,line.find('#')));
+      string directory;
+      if(!(ss >> directory))
+	continue;
+      vector<string> overrides;
+      string item;
+      while(ss >> item)
+	overrides.push_back(item);
+      res.push_back(BatchRun(directory, overrides));
+    }
+    return res;
+  }
+
+  // Runs in the child process, and never returns
+  void run_child(const BatchRun& run,
+		 const Config& base,
+		 const EosTables& tables,
+		 const ReactionNetwork& network,
+		 const InitialData& id)
+  {
+    int status = 1;
+    try{
+      const Config config(base, run.overrides);
+      if(mkdir(run.directory.c_str(),0755)!=0 && errno!=EEXIST)
+	throw "failed to create " + run.directory;
+      if(chdir(run.directory.c_str())!=0)
+	throw "failed to enter " + run.directory;
+      unlink("wall_time.txt");
+      run_simulation(config, tables, network, id);
+      status = 0;
+    }
+    catch(const string& error){
+      std::cerr << run.directory << ": " << error << std::endl;
+    }
+    catch(const char* error){
+      std::cerr << run.directory << ": " << error << std::endl;
+    }
+    std::cout.flush();
+    _exit(status);
+  }
+
+  map<string,double> read_wall_time(const string& directory)
+  {
+    map<string,double> res;
+    std::ifstream f((directory+"/wall_time.txt").c_str());
+    string key;
+    double value = 0;
+    while(f >> key >> value)
+      res[key] = value;
+    return res;
+  }
+}
+
+int run_batch(const string& fname,
+	      const Config& base,
+	      size_t jobs,
+	      const EosTables& tables,
+	      const ReactionNetwork& network,
+	      const InitialData& id)
+{
+  assert(jobs>0);
+  vector<BatchRun> runs = read_batch(fname);
+  std::ofstream report("batch_report.csv");
+  report << "directory,status,wall,startup,cycles,cells,"
+	 << "cycles_per_second,cell_updates_per_second,"
+	 << "static_mesh,time_advance_per_cycle\n";
+  report.flush();
+  size_t next = 0;
+  size_t running = 0;
+  int failed = 0;
+  while(next<runs.size() || running>0){
+    if(next<runs.size() && running<jobs){
+      std::cout.flush();
+      const pid_t pid = fork();
+      if(pid<0)
+	throw string("fork failed");
+      if(pid==0)
+	run_child(runs[next], base, tables, network, id);
+      runs[next].pid = pid;
+      runs[next].start = wall_clock();
+      ++next;
+      ++running;
+      continue;
+    }
+    int status = 0;
+    const pid_t pid = wait(&status);
+    if(pid<0)
+      throw string("wait failed");
+    --running;
+    for(size_t i=0;i<next;++i){
+      if(runs[i].pid!=pid)
+	continue;
+      const double wall = wall_clock() - runs[i].start;
+      const bool success = WIFEXITED(status) && WEXITSTATUS(status)==0;
+      if(!success)
+	++failed;
+      map<string,double> times = read_wall_time(runs[i].directory);
+      const double cycles = times["cycles"];
+      report << runs[i].directory << ","
+	     << (success ? "ok" : "failed") << ","
+	     << wall << ","
+	     << times["startup"] << ","
+	     << cycles << ","
+	     << times["cells"] << ","
+	     << cycles/wall << ","
+	     << cycles*times["cells"]/wall << ","
+	     << times["static_mesh"] << ","
+	     << times["time_advance_per_cycle"] << "\n";
+      report.flush();
+      std::cout << runs[i].directory << " finished in " << wall << " s"
+		<< std::endl;
+    }
+  }
+  return failed;
+}
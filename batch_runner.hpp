@@ -0,0 +1,28 @@
+#ifndef BATCH_RUNNER_HPP
+#define BATCH_RUNNER_HPP 1
+
+#include "run_simulation.hpp"
+
+/*! \brief Runs every configuration in a batch file, each in its own directory
+  \details Each line of the batch file holds a directory followed by
+  key=value overrides, and anything after # is ignored. Every run is a
+  child process forked after the tables and profiles are loaded, so the
+  runs share them without sharing the global Fortran state. Up to a given
+  number of runs execute at the same time. The wall time and throughput
+  of each run go to batch_report.csv.
+  \param fname Name of batch file
+  \param base Configuration shared by all runs
+  \param jobs Maximum number of concurrent runs
+  \param tables Equation of state tables
+  \param network Reaction network
+  \param id Initial profiles
+  \return Number of failed runs
+ */
+int run_batch(const string& fname,
+	      const Config& base,
+	      size_t jobs,
+	      const EosTables& tables,
+	      const ReactionNetwork& network,
+	      const InitialData& id);
+
+#endif // BATCH_RUNNER_HPP
@@ -0,0 +1,556 @@
+/*
+  Micro benchmarks for the equation of state, the batched electron table
+  kernel, burn network, profile interpolator and flux calculator, the
+  latter with and without the batched bulk edge solver, and in OpenMP
+  builds for every thread count from one to all cores. Run from a
+  simulation directory:
+
+  ./bench <label> [snapshot.h5] [seconds per kernel]
+
+  Every kernel runs on the initial conditions built from the text
+  profiles, and again on the live cells of the snapshot (initial.h5 by
+  default) when it exists. Results are appended to benchmark_results.csv
+  under the given label, e.g. the git commit. The electron table kernel is
+  checked against rho_tmp.f90, and the batched fluxes against the per edge
+  ones, before they are timed. The exit status is nonzero when the electron
+  table disagrees with rho_tmp.f90 beyond its tolerances.
+ */
+
+#include <fstream>
+#include <cstdlib>
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <sstream>
+#include "benchmark.hpp"
+#include "cell_states.hpp"
+#include "units.hpp"
+#include "sim_data.hpp"
+#include "interpolator.hpp"
+#include "burn_step_wrapper.hpp"
+#include "reaction_network.hpp"
+#include "safe_retrieve.hpp"
+#include "electron_check.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+
+  class DensityTemperatureToPressure: public Kernel
+  {
+  public:
+
+    DensityTemperatureToPressure(const FermiTable& eos,
+				 const vector<CellState>& states):
+      eos_(eos), states_(states) {}
+
+    string getName(void) const
+    {
+      return "eos_dt2p";
+    }
+
+    size_t getCallsPerSweep(void) const
+    {
+      return states_.size();
+    }
+
+    double sweep(void)
+    {
+      double res = 0;
+      for(size_t i=0;i<states_.size();++i)
+	res += eos_.dt2p(states_[i].density,
+			 states_[i].temperature,
+			 states_[i].tracers);
+      return res;
+    }
+
+  private:
+    const FermiTable& eos_;
+    const vector<CellState>& states_;
+  };
+
+  class DensityPressureToTemperature: public Kernel
+  {
+  public:
+
+    DensityPressureToTemperature(const FermiTable& eos,
+				 const vector<CellState>& states):
+      eos_(eos), states_(states) {}
+
+    string getName(void) const
+    {
+      return "eos_dp2t";
+    }
+
+    size_t getCallsPerSweep(void) const
+    {
+      return states_.size();
+    }
+
+    double sweep(void)
+    {
+      double res = 0;
+      for(size_t i=0;i<states_.size();++i)
+	res += eos_.dp2t(states_[i].density,
+			 states_[i].pressure,
+			 states_[i].tracers);
+      return res;
+    }
+
+  private:
+    const FermiTable& eos_;
+    const vector<CellState>& states_;
+  };
+
+  class DensityEnergyToPressure: public Kernel
+  {
+  public:
+
+    DensityEnergyToPressure(const FermiTable& eos,
+			    const vector<CellState>& states):
+      eos_(eos), states_(states) {}
+
+    string getName(void) const
+    {
+      return "eos_de2p";
+    }
+
+    size_t getCallsPerSweep(void) const
+    {
+      return states_.size();
+    }
+
+    double sweep(void)
+    {
+      double res = 0;
+      for(size_t i=0;i<states_.size();++i)
+	res += eos_.de2p(states_[i].density,
+			 states_[i].energy,
+			 states_[i].tracers);
+      return res;
+    }
+
+  private:
+    const FermiTable& eos_;
+    const vector<CellState>& states_;
+  };
+
+  class FortranElectronTable: public Kernel
+  {
+  public:
+
+    explicit FortranElectronTable(const ElectronPoints& points):
+      points_(points) {}
+
+    string getName(void) const
+    {
+      return "electron_table_fortran";
+    }
+
+    size_t getCallsPerSweep(void) const
+    {
+      return points_.size();
+    }
+
+    double sweep(void)
+    {
+      return fortran_electron_pressures(points_);
+    }
+
+  private:
+    const ElectronPoints& points_;
+  };
+
+  class BatchedElectronTable: public Kernel
+  {
+  public:
+
+    BatchedElectronTable(const ElectronTable& table,
+			 const ElectronPoints& points):
+      table_(table), points_(points), batch_() {}
+
+    string getName(void) const
+    {
+      return string("electron_table_")+ElectronTable::getInstructionSet();
+    }
+
+    size_t getCallsPerSweep(void) const
+    {
+      return points_.size();
+    }
+
+    double sweep(void)
+    {
+      table_(points_.density, points_.ye, points_.temperature, batch_);
+      double res = 0;
+      for(size_t i=0;i<batch_.pressure.size();++i)
+	res += batch_.pressure[i];
+      return res;
+    }
+
+  private:
+    const ElectronTable& table_;
+    const ElectronPoints& points_;
+    ElectronTable::Batch batch_;
+  };
+
+  class BurnStep: public Kernel
+  {
+  public:
+
+    BurnStep(const FermiTable& eos,
+	     const vector<CellState>& states,
+	     double dt):
+      states_(states),
+      compositions_(),
+      aap_(),
+      dt_(dt)
+    {
+      const vector<string> isotopes = network_isotopes();
+      for(size_t i=0;i<states.size();++i){
+	vector<double> xn(isotopes.size(),0);
+	for(size_t j=0;j<isotopes.size();++j)
+	  xn[j] = safe_retrieve(states[i].tracers,isotopes[j]);
+	compositions_.push_back(xn);
+	aap_.push_back(eos.calcAverageAtomicProperties(states[i].tracers));
+      }
+    }
+
+    string getName(void) const
+    {
+      return "burn_step";
+    }
+
+    size_t getCallsPerSweep(void) const
+    {
+      return states_.size();
+    }
+
+    double sweep(void)
+    {
+      double res = 0;
+      for(size_t i=0;i<states_.size();++i)
+	res += burn_step_wrapper(states_[i].density,
+				 states_[i].energy,
+				 states_[i].temperature,
+				 compositions_[i],
+				 aap_[i],
+				 dt_).first;
+      return res;
+    }
+
+  private:
+    const vector<CellState>& states_;
+    vector<vector<double> > compositions_;
+    vector<pair<double,double> > aap_;
+    const double dt_;
+  };
+
+  class ProfileInterpolation: public Kernel
+  {
+  public:
+
+    ProfileInterpolation(const InitialData& id,
+			 const vector<CellState>& states):
+      interpolator_(id.radius_mid, id.density_list),
+      radii_()
+    {
+      for(size_t i=0;i<states.size();++i){
+	if(states[i].radius>id.radius_mid.front() &&
+	   states[i].radius<id.radius_mid.back())
+	  radii_.push_back(states[i].radius);
+      }
+    }
+
+    string getName(void) const
+    {
+      return "interpolator";
+    }
+
+    size_t getCallsPerSweep(void) const
+    {
+      return radii_.size();
+    }
+
+    double sweep(void)
+    {
+      double res = 0;
+      for(size_t i=0;i<radii_.size();++i)
+	res += interpolator_(radii_[i]);
+      return res;
+    }
+
+  private:
+    const Interpolator interpolator_;
+    vector<double> radii_;
+  };
+
+  /* Fluxes of every edge. Given a cache, it is emptied before each sweep,
+     so every cell state is inverted rather than reused */
+  class HydroFlux: public Kernel
+  {
+  public:
+
+    HydroFlux(const string& name,
+	      const hdsim& sim,
+	      const FluxCalculator& fc,
+	      const EquationOfState& eos,
+	      EosCache* cold_cache=0):
+      name_(name),
+      sim_(sim),
+      fc_(fc),
+      eos_(eos),
+      cold_cache_(cold_cache),
+      point_velocities_
+      (static_cast<size_t>(sim.getTessellation().GetPointNo()),
+       Vector2D(0,0)) {}
+
+    string getName(void) const
+    {
+      return name_;
+    }
+
+    size_t getCallsPerSweep(void) const
+    {
+      return sim_.getTessellation().getAllEdges().size();
+    }
+
+    vector<Extensive> calcFluxes(void) const
+    {
+      return fc_(sim_.getTessellation(),
+		 point_velocities_,
+		 sim_.getAllCells(),
+		 sim_.getAllExtensives(),
+		 sim_.getCacheData(),
+		 eos_,
+		 sim_.getTime(),
+		 0);
+    }
+
+    double sweep(void)
+    {
+      if(cold_cache_)
+	cold_cache_->invalidate();
+      const vector<Extensive> fluxes = calcFluxes();
+      double res = 0;
+      for(size_t i=0;i<fluxes.size();++i)
+	res += fluxes[i].mass;
+      return res;
+    }
+
+  private:
+    const string name_;
+    const hdsim& sim_;
+    const FluxCalculator& fc_;
+    const EquationOfState& eos_;
+    EosCache* cold_cache_;
+    const vector<Vector2D> point_velocities_;
+  };
+
+  /* Largest deviation between two sets of fluxes, with each component
+     relative to its largest magnitude over all edges */
+  double flux_deviation(const vector<Extensive>& actual,
+			const vector<Extensive>& expected)
+  {
+    double scale[4] = {0, 0, 0, 0};
+    for(size_t i=0;i<expected.size();++i){
+      scale[0] = std::max(scale[0], std::abs(expected[i].mass));
+      scale[1] = std::max(scale[1], std::abs(expected[i].momentum.x));
+      scale[2] = std::max(scale[2], std::abs(expected[i].momentum.y));
+      scale[3] = std::max(scale[3], std::abs(expected[i].energy));
+    }
+    double res = 0;
+    for(size_t i=0;i<expected.size();++i){
+      const double diff[4] =
+	{actual[i].mass-expected[i].mass,
+	 actual[i].momentum.x-expected[i].momentum.x,
+	 actual[i].momentum.y-expected[i].momentum.y,
+	 actual[i].energy-expected[i].energy};
+      for(size_t k=0;k<4;++k){
+	const double value = std::abs(diff[k])/std::max(scale[k], 1e-300);
+	// Also catches NaN
+	if(!(value<=res))
+	  res = value;
+      }
+    }
+    return res;
+  }
+
+#ifdef _OPENMP
+  /* Times a flux calculator for one thread, doubling up to all cores, and
+     checks the fluxes do not depend on the thread count */
+  void run_flux_scaling(HydroFlux& flux,
+			double min_time,
+			BenchmarkLog& log)
+  {
+    const int max_threads = omp_get_max_threads();
+    vector<int> thread_counts;
+    for(int n=1;n<max_threads;n*=2)
+      thread_counts.push_back(n);
+    thread_counts.push_back(max_threads);
+    omp_set_num_threads(1);
+    const vector<Extensive> serial = flux.calcFluxes();
+    double serial_time = 0;
+    for(size_t i=0;i<thread_counts.size();++i){
+      const int n = thread_counts[i];
+      omp_set_num_threads(n);
+      std::ostringstream input;
+      input << "profile_threads_" << n;
+      const BenchmarkResult result =
+	run_benchmark(flux, input.str(), min_time);
+      log(result);
+      if(i==0)
+	serial_time = result.nsPerCall();
+      const double speedup = serial_time/result.nsPerCall();
+      std::cout << "flux on " << n << " threads: speedup " << speedup
+		<< ", efficiency " << speedup/static_cast<double>(n)
+		<< ", deviation from one thread "
+		<< flux_deviation(flux.calcFluxes(), serial) << std::endl;
+    }
+    omp_set_num_threads(max_threads);
+  }
+#endif
+
+  bool file_exists(const string& fname)
+  {
+    std::ifstream f(fname.c_str());
+    return static_cast<bool>(f);
+  }
+
+  ElectronPoints electron_points(const vector<CellState>& states,
+				 const FermiTable& eos)
+  {
+    ElectronPoints res;
+    for(size_t i=0;i<states.size();++i){
+      const pair<double,double> aap =
+	eos.calcAverageAtomicProperties(states[i].tracers);
+      res.add(states[i].density,
+	      aap.second/aap.first,
+	      states[i].temperature);
+    }
+    return res;
+  }
+
+  /* Times the batched electron kernel against rho_tmp.f90, after
+     checking that the two agree. Returns whether they do */
+  bool run_electron_kernels(const EosTables& tables,
+			    const ElectronTable& table,
+			    const ElectronPoints& points,
+			    const string& input,
+			    double min_time,
+			    BenchmarkLog& log)
+  {
+    const ElectronDeviation deviation =
+      compare_electron_table(tables, table, points);
+    std::cout << "electron table on " << input
+	      << ": largest deviation from rho_tmp " << deviation.value
+	      << " in " << deviation.name
+	      << " (tolerance " << deviation.tolerance << ")" << std::endl;
+    if(!deviation.passed())
+      std::cout << "electron table on " << input << ": FAILED, "
+		<< deviation.failures << " values over tolerance"
+		<< std::endl;
+    FortranElectronTable fortran(points);
+    log(run_benchmark(fortran, input, min_time));
+    BatchedElectronTable batched(table, points);
+    log(run_benchmark(batched, input, min_time));
+    return deviation.passed();
+  }
+
+  void run_state_kernels(const FermiTable& eos,
+			 const InitialData& id,
+			 const vector<CellState>& states,
+			 const string& input,
+			 double burn_dt,
+			 double min_time,
+			 BenchmarkLog& log)
+  {
+    DensityTemperatureToPressure dt2p(eos, states);
+    log(run_benchmark(dt2p, input, min_time));
+    DensityPressureToTemperature dp2t(eos, states);
+    log(run_benchmark(dp2t, input, min_time));
+    DensityEnergyToPressure de2p(eos, states);
+    log(run_benchmark(de2p, input, min_time));
+    BurnStep burn(eos, states, burn_dt);
+    log(run_benchmark(burn, input, min_time));
+    ProfileInterpolation interp(id, states);
+    log(run_benchmark(interp, input, min_time));
+  }
+}
+
+int main(int argc, char** argv)
+{
+  const string label = argc>1 ? argv[1] : "unlabeled";
+  const string snapshot = argc>2 ? argv[2] : "initial.h5";
+  const double min_time = argc>3 ? atof(argv[3]) : 1;
+  const double burn_dt = 1e-4;
+
+  // Default run parameters, and the same with the per edge flux loop
+  const Config config(1, argv);
+  const Config per_edge_config
+    (config, VectorInitialiser<string>("flux_batch_bulk=false")());
+  const Units units;
+  const EosTables tables(config.getString("eos_table","eos_tab.coded"));
+  const ReactionNetwork network(config.getString("burn_table",
+						 "alpha_table"));
+  const InitialData id = load_initial_data(config);
+  SimData sim_data(config, tables, id, units, wedge_domain(config, id));
+  const FermiTable& eos = sim_data.getEOS();
+  BenchmarkLog log("benchmark_results.csv", label);
+
+  const vector<CellState> synthetic =
+    simulation_states(sim_data.getSim(), eos);
+  run_state_kernels(eos, id, synthetic, "profile",
+		    burn_dt, min_time, log);
+  const ElectronTable electrons(tables);
+  bool electrons_agree =
+    run_electron_kernels(tables, electrons,
+			 electron_points(synthetic, eos), "profile",
+			 min_time, log);
+  electrons_agree =
+    run_electron_kernels(tables, electrons,
+			 table_sweep(tables, 300), "table_sweep",
+			 min_time, log) && electrons_agree;
+  if(file_exists(snapshot)){
+    const vector<CellState> recorded =
+      recorded_states(snapshot, eos);
+    run_state_kernels(eos, id, recorded, snapshot,
+		      burn_dt, min_time, log);
+    electrons_agree =
+      run_electron_kernels(tables, electrons,
+			   electron_points(recorded, eos), snapshot,
+			   min_time, log) && electrons_agree;
+  }
+  else
+    std::cout << snapshot << " not found, skipping recorded states"
+	      << std::endl;
+
+  SimData per_edge_data(per_edge_config, tables, id, units,
+			wedge_domain(per_edge_config, id));
+  HydroFlux per_edge("inner_bc_flux_per_edge",
+		     per_edge_data.getSim(),
+		     per_edge_data.getFluxCalculator(),
+		     per_edge_data.getEOS());
+  HydroFlux batched("inner_bc_flux_batched",
+		    sim_data.getSim(),
+		    sim_data.getFluxCalculator(),
+		    eos);
+  std::cout << "bulk edge solver (" << BulkHllc::getInstructionSet()
+	    << "): largest flux deviation from the per edge loop "
+	    << flux_deviation(batched.calcFluxes(), per_edge.calcFluxes())
+	    << std::endl;
+  log(run_benchmark(per_edge, "profile", min_time));
+  log(run_benchmark(batched, "profile", min_time));
+#ifdef _OPENMP
+  // Every cell state is inverted, so the threaded equation of state calls
+  // are timed too
+  HydroFlux cold("inner_bc_flux_batched_cold",
+		 sim_data.getSim(),
+		 sim_data.getFluxCalculator(),
+		 eos,
+		 &sim_data.getEOSCache());
+  run_flux_scaling(cold, min_time, log);
+#endif
+  return electrons_agree ? 0 : 1;
+}
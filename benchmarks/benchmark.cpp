@@ -0,0 +1,80 @@
+#include <iostream>
+#include "benchmark.hpp"
+#include "wall_clock.hpp"
+
+Kernel::~Kernel(void) {}
+
+BenchmarkResult::BenchmarkResult(const string& kernel_i,
+				 const string& input_i,
+				 size_t calls_i,
+				 double seconds_i,
+				 double checksum_i):
+  kernel(kernel_i),
+  input(input_i),
+  calls(calls_i),
+  seconds(seconds_i),
+  checksum(checksum_i) {}
+
+double BenchmarkResult::nsPerCall(void) const
+{
+  return 1e9*seconds/static_cast<double>(calls);
+}
+
+double BenchmarkResult::callsPerSecond(void) const
+{
+  return static_cast<double>(calls)/seconds;
+}
+
+BenchmarkResult run_benchmark(Kernel& kernel,
+			      const string& input,
+			      double min_time)
+{
+  // Warm up caches and lazily initialised state
+  double checksum = kernel.sweep();
+  size_t sweeps = 0;
+  const double start = wall_clock();
+  double elapsed = 0;
+  while(elapsed<min_time){
+    checksum += kernel.sweep();
+    ++sweeps;
+    elapsed = wall_clock() - start;
+  }
+  return BenchmarkResult(kernel.getName(),
+			 input,
+			 sweeps*kernel.getCallsPerSweep(),
+			 elapsed,
+			 checksum);
+}
+
+namespace {
+  bool is_empty_file(const string& fname)
+  {
+    std::ifstream f(fname.c_str());
+    return !f || f.peek()==std::ifstream::traits_type::eof();
+  }
+}
+
+BenchmarkLog::BenchmarkLog(const string& fname, const string& label):
+  label_(label), f_()
+{
+  const bool write_header = is_empty_file(fname);
+  f_.open(fname.c_str(), std::ios::app);
+  if(write_header)
+    f_ << "label,kernel,input,calls,seconds,ns_per_call,calls_per_second,checksum\n";
+}
+
+void BenchmarkLog::operator()(const BenchmarkResult& result)
+{
+  f_ << label_ << ","
+     << result.kernel << ","
+     << result.input << ","
+     << result.calls << ","
+     << result.seconds << ","
+     << result.nsPerCall() << ","
+     << result.callsPerSecond() << ","
+     << result.checksum << "\n";
+  f_.flush();
+  std::cout << result.kernel << " (" << result.input << "): "
+	    << result.nsPerCall() << " ns/call, "
+	    << result.callsPerSecond() << " calls/s" << std::endl;
+}
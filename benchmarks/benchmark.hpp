@@ -0,0 +1,76 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP 1
+
+#include <string>
+#include <cstddef>
+#include <fstream>
+
+using std::string;
+using std::size_t;
+
+//! \brief A kernel that can be timed
+class Kernel
+{
+public:
+
+  //! \brief Name of the kernel, as it appears in the results
+  virtual string getName(void) const = 0;
+
+  //! \brief Number of kernel calls made by a single sweep
+  virtual size_t getCallsPerSweep(void) const = 0;
+
+  /*! \brief Calls the kernel once for every input
+    \return Checksum of the results, so the calls are not optimised away
+   */
+  virtual double sweep(void) = 0;
+
+  virtual ~Kernel(void);
+};
+
+//! \brief Timing of a single kernel on a single input set
+class BenchmarkResult
+{
+public:
+
+  BenchmarkResult(const string& kernel_i,
+		  const string& input_i,
+		  size_t calls_i,
+		  double seconds_i,
+		  double checksum_i);
+
+  double nsPerCall(void) const;
+
+  double callsPerSecond(void) const;
+
+  const string kernel;
+  const string input;
+  const size_t calls;
+  const double seconds;
+  const double checksum;
+};
+
+/*! \brief Repeats sweeps of a kernel until a minimum time has elapsed
+  \param kernel Kernel
+  \param input Name of the input set
+  \param min_time Minimum measurement time, in seconds
+  \return Timing
+ */
+BenchmarkResult run_benchmark(Kernel& kernel,
+			      const string& input,
+			      double min_time);
+
+//! \brief Appends results to a csv file, with one line per kernel and input
+class BenchmarkLog
+{
+public:
+
+  BenchmarkLog(const string& fname, const string& label);
+
+  void operator()(const BenchmarkResult& result);
+
+private:
+  const string label_;
+  std::ofstream f_;
+};
+
+#endif // BENCHMARK_HPP
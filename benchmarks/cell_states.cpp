@@ -0,0 +1,107 @@
+#include <map>
+#include "H5Cpp.h"
+#include "cell_states.hpp"
+#include "safe_retrieve.hpp"
+
+using std::map;
+using std::pair;
+
+CellState::CellState(void):
+  radius(0),
+  density(0),
+  pressure(0),
+  temperature(0),
+  energy(0),
+  tracers() {}
+
+namespace {
+  void complete_state(CellState& state,
+		      const FermiTable& eos)
+  {
+    const FermiTable::ThermodynamicVariables tv =
+      eos.dp2state(state.density, state.pressure, state.tracers);
+    if(state.temperature<=0)
+      state.temperature = tv.temperature;
+    state.energy = tv.energy;
+  }
+
+  bool dataset_exists(const H5::H5File& f,
+		      const string& name)
+  {
+    return H5Lexists(f.getId(), name.c_str(), H5P_DEFAULT)>0;
+  }
+
+  vector<double> read_dataset(const H5::H5File& f,
+			      const string& name)
+  {
+    const H5::DataSet ds = f.openDataSet(name);
+    const H5::DataSpace space = ds.getSpace();
+    hsize_t n = 0;
+    space.getSimpleExtentDims(&n);
+    vector<double> res(static_cast<size_t>(n),0);
+    ds.read(&res[0], H5::PredType::NATIVE_DOUBLE);
+    return res;
+  }
+}
+
+vector<CellState> simulation_states(const hdsim& sim,
+				    const FermiTable& eos)
+{
+  vector<CellState> res;
+  const vector<ComputationalCell>& cells = sim.getAllCells();
+  const Tessellation& tess = sim.getTessellation();
+  for(size_t i=0;i<cells.size();++i){
+    const ComputationalCell& cell = cells[i];
+    if(safe_retrieve(cell.stickers,string("ghost")))
+      continue;
+    CellState state;
+    state.radius = abs(tess.GetCellCM(static_cast<int>(i)));
+    state.density = cell.density;
+    state.pressure = cell.pressure;
+    state.tracers = cell.tracers;
+    complete_state(state, eos);
+    res.push_back(state);
+  }
+  return res;
+}
+
+vector<CellState> recorded_states(const string& fname,
+				  const FermiTable& eos)
+{
+  const H5::H5File f(fname, H5F_ACC_RDONLY);
+  const vector<double> x = read_dataset(f,"x_coordinate");
+  const vector<double> y = read_dataset(f,"y_coordinate");
+  const vector<double> density = read_dataset(f,"density");
+  const vector<double> pressure = read_dataset(f,"pressure");
+  const vector<double> ghost = read_dataset(f,"ghost");
+  const vector<double> temperature =
+    dataset_exists(f,"temperature") ?
+    read_dataset(f,"temperature") :
+    vector<double>(density.size(),0);
+  map<string,vector<double> > tracers;
+  const map<string,pair<double,double> >& atomic_properties =
+    eos.getAtomicProperties();
+  for(map<string,pair<double,double> >::const_iterator it=
+	atomic_properties.begin();
+      it!=atomic_properties.end();
+      ++it)
+    tracers[it->first] = read_dataset(f,it->first);
+  vector<CellState> res;
+  for(size_t i=0;i<density.size();++i){
+    if(ghost[i]>0.5)
+      continue;
+    CellState state;
+    state.radius = sqrt(x[i]*x[i]+y[i]*y[i]);
+    state.density = density[i];
+    state.pressure = pressure[i];
+    state.temperature = temperature[i];
+    for(map<string,vector<double> >::const_iterator it=
+	  tracers.begin();
+	it!=tracers.end();
+	++it)
+      state.tracers[it->first] = it->second[i];
+    complete_state(state, eos);
+    res.push_back(state);
+  }
+  return res;
+}
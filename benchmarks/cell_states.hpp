@@ -0,0 +1,43 @@
+#ifndef CELL_STATES_HPP
+#define CELL_STATES_HPP 1
+
+#include <vector>
+#include <string>
+#include "source/newtonian/two_dimensional/hdsim2d.hpp"
+#include "fermi_table.hpp"
+
+using std::vector;
+using std::string;
+
+//! \brief Thermodynamic state of a live cell
+class CellState
+{
+public:
+
+  CellState(void);
+
+  double radius;
+  double density;
+  double pressure;
+  double temperature;
+  double energy;
+  boost::container::flat_map<string,double> tracers;
+};
+
+/*! \brief States of the live cells in a simulation
+  \param sim Simulation
+  \param eos Equation of state, used to complete the state
+  \return Live cell states
+ */
+vector<CellState> simulation_states(const hdsim& sim,
+				    const FermiTable& eos);
+
+/*! \brief States of the live cells in a snapshot file
+  \param fname Name of hdf5 snapshot
+  \param eos Equation of state, used to complete the state
+  \return Live cell states
+ */
+vector<CellState> recorded_states(const string& fname,
+				  const FermiTable& eos);
+
+#endif // CELL_STATES_HPP
@@ -0,0 +1,198 @@
+#include <cmath>
+#include <algorithm>
+#include "electron_check.hpp"
+
+extern "C" {
+  void eos_fermi_(int* keyeos,
+		  int* im_gas,
+		  int* im_photons,
+		  int* im_Coulomb,
+		  double* rho_in,
+		  double* enr_in,
+		  double* tmp_in,
+		  double* prs_in,
+		  double* ent_in,
+		  double* abar,
+		  double* zbar,
+		  double* chem_pot,
+		  double* dpdro,
+		  double* dpde,
+		  double* dedro,
+		  double* dedt,
+		  double* sounds,
+		  int* keyerror);
+}
+
+namespace {
+  // Constants as in rho_tmp.f90
+  const double gascon = 6.025e23*1.380662e-16;
+
+  //! \brief Output of eos_fermi for electrons alone
+  class FortranElectrons
+  {
+  public:
+
+    FortranElectrons(double density, double ye, double temperature):
+      pressure(0),
+      energy(0),
+      entropy(0),
+      fermi(0),
+      dp_drho(0),
+      de_drho(0),
+      de_dtmp(0)
+    {
+      // keyeos 1 is rho_tmp. With no gas, photons or Coulomb terms, and
+      // A=1, Z=Ye, only the table contributes.
+      int keyeos = 1;
+      int off = 0;
+      int keyerr = 0;
+      double rho = density;
+      double tmp = temperature;
+      double abar = 1;
+      double zbar = ye;
+      double dpde = 0;
+      double sound_speed = 0;
+      eos_fermi_(&keyeos, &off, &off, &off,
+		 &rho, &energy, &tmp, &pressure, &entropy,
+		 &abar, &zbar,
+		 &fermi, &dp_drho, &dpde, &de_drho, &de_dtmp,
+		 &sound_speed, &keyerr);
+    }
+
+    double pressure;
+    double energy;
+    double entropy;
+    double fermi;
+    double dp_drho;
+    double de_drho;
+    double de_dtmp;
+  };
+}
+
+ElectronDeviation::ElectronDeviation(void):
+  name("none"), value(0), tolerance(1), failures(0) {}
+
+void ElectronDeviation::operator()(const string& quantity,
+				   double actual,
+				   double expected,
+				   double scale,
+				   double tolerance_i)
+{
+  const double diff = std::abs(actual-expected)/
+    std::max(std::abs(scale), 1e-300);
+  // Both comparisons also catch NaN
+  if(!(diff<=tolerance_i))
+    ++failures;
+  if(!(diff/tolerance_i<=value/tolerance)){
+    name = quantity;
+    value = diff;
+    tolerance = tolerance_i;
+  }
+}
+
+bool ElectronDeviation::passed(void) const
+{
+  return failures==0;
+}
+
+ElectronPoints::ElectronPoints(void):
+  density(), ye(), temperature() {}
+
+void ElectronPoints::add(double density_i,
+			 double ye_i,
+			 double temperature_i)
+{
+  density.push_back(density_i);
+  ye.push_back(ye_i);
+  temperature.push_back(temperature_i);
+}
+
+size_t ElectronPoints::size(void) const
+{
+  return density.size();
+}
+
+ElectronPoints table_sweep(const EosTables& tables, size_t n)
+{
+  const vector<double>& xtab = tables.getXTab();
+  const vector<double>& ytab = tables.getYTab();
+  // Extend one spacing past either end to exercise the clamping, and
+  // start below xtab(2) to reach the ideal gas branch
+  const double x_low = xtab.front() - tables.getDXTab();
+  const double x_high = xtab.back() + tables.getDXTab();
+  const double y_low = ytab.front() - tables.getDYTab();
+  const double y_high = ytab.back() + tables.getDYTab();
+  ElectronPoints res;
+  for(size_t i=0;i<n;++i){
+    const double x = x_low + (x_high-x_low)*
+      (static_cast<double>(i)+0.5)/static_cast<double>(n);
+    for(size_t j=0;j<n;++j){
+      const double y = y_low + (y_high-y_low)*
+	(static_cast<double>(j)+0.5)/static_cast<double>(n);
+      const double ye = 0.5 - 0.07*static_cast<double>(j%4);
+      res.add(std::exp(x)/ye, ye, std::exp(y));
+    }
+  }
+  return res;
+}
+
+ElectronDeviation compare_electron_table(const EosTables& tables,
+					 const ElectronTable& table,
+					 const ElectronPoints& points)
+{
+  const double value_tolerance = 1e-9;
+  const double derivative_tolerance = 1e-6;
+  const double x_gas = tables.getXTab()[1];
+  ElectronTable::Batch batch;
+  table(points.density, points.ye, points.temperature, batch);
+  ElectronDeviation deviation;
+  for(size_t i=0;i<points.size();++i){
+    const double rho = points.density[i];
+    const double tmp = points.temperature[i];
+    const FortranElectrons expected(rho, points.ye[i], tmp);
+    const double energy = batch.energy[i]/rho;
+    const double pressure = batch.pressure[i];
+    deviation("pressure", pressure, expected.pressure, pressure,
+	      value_tolerance);
+    deviation("energy", energy, expected.energy, energy, value_tolerance);
+    deviation("entropy",
+	      batch.entropy[i]/rho/gascon,
+	      expected.entropy,
+	      (batch.energy[i]+pressure)/tmp/rho/gascon,
+	      value_tolerance);
+    // rho_tmp.f90 leaves xfermi unset in the ideal gas branch
+    if(std::log(rho*points.ye[i])>x_gas)
+      deviation("fermi",
+		batch.fermi[i],
+		expected.fermi,
+		std::max(std::abs(batch.fermi[i]), 1.0),
+		value_tolerance);
+    deviation("dp_drho",
+	      batch.dp_drho[i],
+	      expected.dp_drho,
+	      pressure/rho,
+	      derivative_tolerance);
+    deviation("de_drho",
+	      (batch.de_drho[i]-batch.energy[i]/rho)/rho,
+	      expected.de_drho,
+	      energy/rho,
+	      derivative_tolerance);
+    // eos_fermi floors de/dT
+    deviation("de_dtmp",
+	      std::max(batch.de_dtmp[i]/rho, 1e-10),
+	      expected.de_dtmp,
+	      energy/tmp,
+	      derivative_tolerance);
+  }
+  return deviation;
+}
+
+double fortran_electron_pressures(const ElectronPoints& points)
+{
+  double res = 0;
+  for(size_t i=0;i<points.size();++i)
+    res += FortranElectrons(points.density[i],
+			    points.ye[i],
+			    points.temperature[i]).pressure;
+  return res;
+}
@@ -0,0 +1,93 @@
+#ifndef ELECTRON_CHECK_HPP
+#define ELECTRON_CHECK_HPP 1
+
+#include <vector>
+#include <string>
+#include "electron_table.hpp"
+
+using std::vector;
+using std::string;
+
+//! \brief Points at which the electron equation of state is evaluated
+class ElectronPoints
+{
+public:
+
+  ElectronPoints(void);
+
+  void add(double density_i, double ye_i, double temperature_i);
+
+  size_t size(void) const;
+
+  vector<double> density;
+  vector<double> ye;
+  vector<double> temperature;
+};
+
+/*! \brief Points spread uniformly in log density and temperature over the
+  table, plus the ideal gas region below it
+  \param tables Loaded tables
+  \param n Number of points along each axis
+  \return Points
+ */
+ElectronPoints table_sweep(const EosTables& tables, size_t n);
+
+//! \brief Agreement of the batched kernel with rho_tmp.f90
+class ElectronDeviation
+{
+public:
+
+  ElectronDeviation(void);
+
+  /*! \brief Compares one quantity at one point
+    \param quantity Name of quantity
+    \param actual Value from the batched kernel
+    \param expected Value from rho_tmp.f90
+    \param scale Magnitude the difference is divided by
+    \param tolerance Largest accepted relative deviation
+   */
+  void operator()(const string& quantity,
+		  double actual,
+		  double expected,
+		  double scale,
+		  double tolerance);
+
+  //! \brief Whether every comparison was within its tolerance
+  bool passed(void) const;
+
+  //! \brief Quantity whose deviation is the largest fraction of its tolerance
+  string name;
+
+  //! \brief Relative deviation of that quantity
+  double value;
+
+  //! \brief Tolerance of that quantity
+  double tolerance;
+
+  //! \brief Number of comparisons over their tolerance
+  size_t failures;
+};
+
+/*! \brief Compares the batched kernel with rho_tmp.f90
+  \details Energy, pressure, entropy and Fermi terms are compared relative
+  to their magnitude, and must agree to 1e-9. Derivatives are compared
+  relative to the natural scale (e.g. p/rho for dp/drho), since near
+  degenerate cells some of them are small differences of large stencil
+  terms, and must agree to 1e-6.
+  \param tables Loaded tables
+  \param table Batched kernel
+  \param points Evaluation points
+  \return Worst quantity and the number of failed comparisons
+ */
+ElectronDeviation compare_electron_table(const EosTables& tables,
+					 const ElectronTable& table,
+					 const ElectronPoints& points);
+
+/*! \brief Evaluates the electron contributions one point at a time with
+  rho_tmp.f90
+  \param points Evaluation points
+  \return Sum of pressures, as a checksum
+ */
+double fortran_electron_pressures(const ElectronPoints& points);
+
+#endif // ELECTRON_CHECK_HPP
@@ -0,0 +1,267 @@
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "bulk_hllc.hpp"
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+namespace {
+
+  //! \brief Arithmetic on one edge at a time
+  class ScalarLanes
+  {
+  public:
+
+    typedef double Value;
+
+    static const size_t width = 1;
+
+    static Value load(const double* p) {return *p;}
+
+    static void store(double* p, Value v) {*p = v;}
+
+    static Value set(double v) {return v;}
+
+    static Value add(Value a, Value b) {return a+b;}
+
+    static Value sub(Value a, Value b) {return a-b;}
+
+    static Value mul(Value a, Value b) {return a*b;}
+
+    static Value div(Value a, Value b) {return a/b;}
+
+    static Value min(Value a, Value b) {return std::min(a,b);}
+
+    static Value max(Value a, Value b) {return std::max(a,b);}
+
+    //! \brief if_true where x>0, otherwise if_false
+    static Value positive(Value x, Value if_true, Value if_false)
+    {
+      return x>0 ? if_true : if_false;
+    }
+
+    //! \brief if_true where x>=0, otherwise if_false
+    static Value non_negative(Value x, Value if_true, Value if_false)
+    {
+      return x>=0 ? if_true : if_false;
+    }
+  };
+
+#ifdef __AVX__
+  //! \brief Arithmetic on four edges at a time
+  class AvxLanes
+  {
+  public:
+
+    typedef __m256d Value;
+
+    static const size_t width = 4;
+
+    static Value load(const double* p) {return _mm256_loadu_pd(p);}
+
+    static void store(double* p, Value v) {_mm256_storeu_pd(p, v);}
+
+    static Value set(double v) {return _mm256_set1_pd(v);}
+
+    static Value add(Value a, Value b) {return _mm256_add_pd(a,b);}
+
+    static Value sub(Value a, Value b) {return _mm256_sub_pd(a,b);}
+
+    static Value mul(Value a, Value b) {return _mm256_mul_pd(a,b);}
+
+    static Value div(Value a, Value b) {return _mm256_div_pd(a,b);}
+
+    // Same operand order as std::min and std::max
+    static Value min(Value a, Value b) {return _mm256_min_pd(b,a);}
+
+    static Value max(Value a, Value b) {return _mm256_max_pd(b,a);}
+
+    static Value positive(Value x, Value if_true, Value if_false)
+    {
+      return _mm256_blendv_pd
+	(if_false, if_true,
+	 _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_GT_OQ));
+    }
+
+    static Value non_negative(Value x, Value if_true, Value if_false)
+    {
+      return _mm256_blendv_pd
+	(if_false, if_true,
+	 _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_GE_OQ));
+    }
+  };
+
+  typedef AvxLanes WideLanes;
+#else
+  typedef ScalarLanes WideLanes;
+#endif
+
+  //! \brief State on one side of the edges, in the frame of the edge
+  template<class L> class Side
+  {
+  public:
+
+    typedef typename L::Value Value;
+
+    Side(const BulkHllc::States& states, size_t i, Value face_velocity):
+      d(L::load(&states.density[i])),
+      p(L::load(&states.pressure[i])),
+      c(L::load(&states.sound_speed[i])),
+      u(L::sub(L::load(&states.normal_velocity[i]), face_velocity)),
+      t(L::load(&states.parallel_velocity[i])),
+      energy_density
+      (L::mul(d,
+	      L::add(L::load(&states.energy[i]),
+		     L::mul(L::set(0.5),
+			    L::add(L::mul(u,u), L::mul(t,t)))))) {}
+
+    /*! \brief Flux of this side, and the flux through its star region
+      \param s Outer wave speed on this side
+      \param ss Contact speed
+      \param f Flux: mass, normal momentum, parallel momentum, energy
+      \param fs Star region flux, same order
+     */
+    void fluxes(Value s, Value ss, Value f[4], Value fs[4]) const
+    {
+      f[0] = L::mul(d,u);
+      f[1] = L::add(L::mul(f[0],u), p);
+      f[2] = L::mul(f[0],t);
+      f[3] = L::mul(L::add(energy_density,p), u);
+      const Value su = L::sub(s,u);
+      const Value ds = L::div(L::mul(d,su), L::sub(s,ss));
+      const Value us[4] =
+	{ds,
+	 L::mul(ds,ss),
+	 L::mul(ds,t),
+	 L::mul(ds,
+		L::add(L::div(energy_density,d),
+		       L::mul(L::sub(ss,u),
+			      L::add(ss, L::div(p, L::mul(d,su))))))};
+      const Value uc[4] = {d, L::mul(d,u), L::mul(d,t), energy_density};
+      for(size_t k=0;k<4;++k)
+	fs[k] = L::add(f[k], L::mul(s, L::sub(us[k],uc[k])));
+    }
+
+    const Value d;
+    const Value p;
+    const Value c;
+    const Value u;
+    const Value t;
+    const Value energy_density;
+  };
+
+  //! \brief Solves L::width edges starting at i
+  template<class L> void solve(BulkHllc::Batch& batch, size_t i)
+  {
+    typedef typename L::Value Value;
+    const Value w = L::load(&batch.face_velocity[i]);
+    const Side<L> left(batch.left, i, w);
+    const Side<L> right(batch.right, i, w);
+    // Davis estimates
+    const Value sl = L::min(L::sub(left.u,left.c), L::sub(right.u,right.c));
+    const Value sr = L::max(L::add(left.u,left.c), L::add(right.u,right.c));
+    const Value ml = L::mul(left.d, L::sub(sl,left.u));
+    const Value mr = L::mul(right.d, L::sub(sr,right.u));
+    const Value ss = L::div
+      (L::add(L::sub(right.p,left.p),
+	      L::sub(L::mul(ml,left.u), L::mul(mr,right.u))),
+       L::sub(ml,mr));
+    Value fl[4], fsl[4], fr[4], fsr[4];
+    left.fluxes(sl, ss, fl, fsl);
+    right.fluxes(sr, ss, fr, fsr);
+    Value f[4];
+    for(size_t k=0;k<4;++k)
+      f[k] = L::positive
+	(sl, fl[k],
+	 L::non_negative
+	 (ss, fsl[k],
+	  L::non_negative(sr, fsr[k], fr[k])));
+    // Back to the lab frame
+    f[3] = L::add(f[3],
+		  L::add(L::mul(f[1],w),
+			 L::mul(L::set(0.5), L::mul(f[0], L::mul(w,w)))));
+    f[1] = L::add(f[1], L::mul(w,f[0]));
+    L::store(&batch.mass[i], f[0]);
+    L::store(&batch.normal_momentum[i], f[1]);
+    L::store(&batch.parallel_momentum[i], f[2]);
+    L::store(&batch.energy[i], f[3]);
+  }
+}
+
+BulkHllc::States::States(size_t n):
+  density(n),
+  pressure(n),
+  energy(n),
+  sound_speed(n),
+  normal_velocity(n),
+  parallel_velocity(n) {}
+
+void BulkHllc::States::resize(size_t n)
+{
+  density.resize(n);
+  pressure.resize(n);
+  energy.resize(n);
+  sound_speed.resize(n);
+  normal_velocity.resize(n);
+  parallel_velocity.resize(n);
+}
+
+BulkHllc::Batch::Batch(size_t n):
+  left(n),
+  right(n),
+  face_velocity(n),
+  mass(n),
+  normal_momentum(n),
+  parallel_momentum(n),
+  energy(n) {}
+
+void BulkHllc::Batch::resize(size_t n)
+{
+  left.resize(n);
+  right.resize(n);
+  face_velocity.resize(n);
+  mass.resize(n);
+  normal_momentum.resize(n);
+  parallel_momentum.resize(n);
+  energy.resize(n);
+}
+
+size_t BulkHllc::Batch::size(void) const
+{
+  return face_velocity.size();
+}
+
+BulkHllc::BulkHllc(void) {}
+
+void BulkHllc::operator()(Batch& batch) const
+{
+  const size_t n = batch.size();
+  const size_t width = WideLanes::width;
+  const int n_blocks = static_cast<int>(n/width);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for(int j=0;j<n_blocks;++j)
+    solve<WideLanes>(batch, width*static_cast<size_t>(j));
+  size_t i = width*static_cast<size_t>(n_blocks);
+  for(;i<n;++i)
+    solve<ScalarLanes>(batch, i);
+  // A NaN or infinite input shows up in the sum, where the scalar solver
+  // would have failed to pick a region
+  double check = 0;
+  for(i=0;i<n;++i)
+    check += batch.mass[i] + batch.energy[i] +
+      batch.normal_momentum[i] + batch.parallel_momentum[i];
+  if(!(std::abs(check)<=std::numeric_limits<double>::max()))
+    throw "BulkHllc: non finite flux";
+}
+
+const char* BulkHllc::getInstructionSet(void)
+{
+#ifdef __AVX__
+  return "avx";
+#else
+  return "scalar";
+#endif
+}
@@ -0,0 +1,86 @@
+#ifndef BULK_HLLC_HPP
+#define BULK_HLLC_HPP 1
+
+#include <vector>
+#include <cstddef>
+
+using std::vector;
+using std::size_t;
+
+/*! \brief HLLC fluxes for a batch of edges, in structure of arrays form
+  \details Solves the same problem as the Hllc class of RICH: states are
+  given in the frame of the edge, with Davis estimates of the outer wave
+  speeds and the contact speed and star states of Toro. Every edge goes
+  through the same arithmetic, and the region is chosen by selects rather
+  than branches, so four edges at a time share one AVX register. Builds
+  without AVX use a scalar loop. The loop is split statically between
+  OpenMP threads.
+ */
+class BulkHllc
+{
+public:
+
+  //! \brief States on one side of the edges
+  class States
+  {
+  public:
+
+    explicit States(size_t n=0);
+
+    void resize(size_t n);
+
+    vector<double> density;
+
+    vector<double> pressure;
+
+    //! \brief Specific thermal energy
+    vector<double> energy;
+
+    vector<double> sound_speed;
+
+    //! \brief Velocity along the edge normal, from left to right
+    vector<double> normal_velocity;
+
+    //! \brief Velocity along the edge
+    vector<double> parallel_velocity;
+  };
+
+  //! \brief Input states and output fluxes of a batch
+  class Batch
+  {
+  public:
+
+    explicit Batch(size_t n=0);
+
+    void resize(size_t n);
+
+    size_t size(void) const;
+
+    States left;
+
+    States right;
+
+    //! \brief Velocity of the edge along its normal
+    vector<double> face_velocity;
+
+    vector<double> mass;
+
+    vector<double> normal_momentum;
+
+    vector<double> parallel_momentum;
+
+    vector<double> energy;
+  };
+
+  BulkHllc(void);
+
+  /*! \brief Calculates the fluxes
+    \param batch States in, fluxes out, in the lab frame
+   */
+  void operator()(Batch& batch) const;
+
+  //! \brief Instruction set of the solver loop
+  static const char* getInstructionSet(void);
+};
+
+#endif // BULK_HLLC_HPP
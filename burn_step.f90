@@ -1,5 +1,6 @@
 module global
   real(8),save :: xnorm
+!$omp threadprivate(xnorm)
 end module global
 ! =================================================================
 subroutine burn_step (indxeos,rho,enr,tmp,x,amol,zmol,dedtmp  &
@@ -0,0 +1,98 @@
+#include <fstream>
+#include <cassert>
+#include "burn_step_wrapper.hpp"
+#include "source/misc/vector_initialiser.hpp"
+
+extern "C" {
+
+  void initnet_(const char* rfile);
+
+  void burn_step_(int* indexeos,
+		  double* density,
+		  double* energy,
+		  double* tburn,
+		  double* xn,
+		  double* atomw,
+		  double* atomn,
+		  double* dedtmp,
+		  int* matters,
+		  double* dt,
+		  double* qrec,
+		  int* nse,
+		  double* tmp_nse,
+		  int* key_done,
+		  char* screen_type);
+}
+
+void init_network(const string& rfile)
+{
+  initnet_(rfile.c_str());
+}
+
+vector<string> network_isotopes(void)
+{
+  return VectorInitialiser<string>("He4")
+    ("C12")
+    ("O16")
+    ("Ne20")
+    ("Mg24")
+    ("Si28")
+    ("S32")
+    ("Ar36")
+    ("Ca40")
+    ("Ti44")
+    ("Cr48")
+    ("Fe52")
+    ("Ni56")();
+}
+
+pair<double,vector<double> > burn_step_wrapper(double density,
+					       double energy,
+					       double tburn,
+					       vector<double> xn,
+					       pair<double,double> az,
+					       double dt)
+{
+  int indexeos = 0;
+  double dedtmp = 0;
+  int matters = static_cast<int>(xn.size());
+  double qrec = 0;
+  int nse = 0;
+  double tmp_nse = 1e10;
+  char screen_type[80] = "default";
+  int key_done = 0;
+  burn_step_(&indexeos,
+	     &density,
+	     &energy,
+	     &tburn,
+	     &xn[0],
+	     &az.first,
+	     &az.second,
+	     &dedtmp,
+	     &matters,
+	     &dt,
+	     &qrec,
+	     &nse,
+	     &tmp_nse,
+	     &key_done,
+	     screen_type);
+  if(key_done!=1){
+    // Burns run in parallel, so only one thread writes the report and
+    // stops the run
+#ifdef _OPENMP
+#pragma omp critical(burn_step_error_report)
+#endif
+    {
+      std::ofstream f("burn_step_error_report.txt");
+      f << "density = " << density << "\n";
+      f << "energy = " << energy << "\n";
+      f << "temperature = " << tburn << "\n";
+      f << "atomic weight = " << az.first << "\n";
+      f << "atomic number = " << az.second << "\n";
+      f << "dt = " << dt << "\n";
+      f.close();
+      assert(key_done==1);
+    }
+  }
+  return pair<double,vector<double> >(qrec,xn);
+}
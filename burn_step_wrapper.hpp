@@ -0,0 +1,34 @@
+#ifndef BURN_STEP_WRAPPER_HPP
+#define BURN_STEP_WRAPPER_HPP 1
+
+#include <vector>
+#include <string>
+#include <utility>
+
+using std::vector;
+using std::string;
+using std::pair;
+
+//! \brief Loads the reaction network
+void init_network(const string& rfile);
+
+//! \brief Isotope names in the order used by the network
+vector<string> network_isotopes(void);
+
+/*! \brief Advances the composition of a single cell
+  \param density Density
+  \param energy Specific thermal energy
+  \param tburn Temperature
+  \param xn Mass fractions, in network order
+  \param az Average atomic weight and atomic number
+  \param dt Time step
+  \return Energy release rate and new mass fractions
+ */
+pair<double,vector<double> > burn_step_wrapper(double density,
+					       double energy,
+					       double tburn,
+					       vector<double> xn,
+					       pair<double,double> az,
+					       double dt);
+
+#endif // BURN_STEP_WRAPPER_HPP
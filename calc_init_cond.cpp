@@ -1,66 +1,99 @@
+#include <algorithm>
 #include "calc_init_cond.hpp"
-#include "create_pressure_reference.hpp"
-#include "vector_io.hpp"
-#include "interpolator.hpp"
+
+namespace {
+
+  // Position of a radius between two profile points, kept as an offset and
+  // a span so the interpolation rounds the same way as Interpolator
+  class Bracket
+  {
+  public:
+
+    Bracket(void): index(0), offset(0), span(1) {}
+
+    Bracket(const vector<double>& x_list, double x):
+      index(0), offset(0), span(1)
+    {
+      assert(x>x_list.front() && x<x_list.back());
+      index = static_cast<size_t>
+	(std::upper_bound(x_list.begin(),x_list.end(),x)-x_list.begin());
+      offset = x - x_list[index-1];
+      span = x_list[index] - x_list[index-1];
+    }
+
+    double operator()(const vector<double>& y_list) const
+    {
+      return y_list[index-1] +
+	(y_list[index]-y_list[index-1])*offset/span;
+    }
+
+    size_t index;
+    double offset;
+    double span;
+  };
+}
 
 vector<ComputationalCell> calc_init_cond(const Tessellation& tess,
 					 const FermiTable& eos,
 					 const InitialData& id,
-					 const Shape2D& cd)
+					 const Shape2D& cd,
+					 vector<double>& temperatures)
 {
-  save_txt("pressure_reference.txt",create_pressure_reference(eos,id));
-  vector<ComputationalCell> res(static_cast<size_t>(tess.GetPointNo()));
-  const Interpolator density_interpolator(id.radius_mid,
-					  id.density_list);
-  const Interpolator temperature_interpolator(id.radius_mid,
-					      id.temperature_list);
-  const Interpolator velocity_interpolator(id.radius_list,
-					   id.velocity_list);
-  map<string,Interpolator*> tracer_intepolators;
+  const int n = tess.GetPointNo();
+  vector<ComputationalCell> res(static_cast<size_t>(n));
+
+  // All cells start as ghosts, which share one state
+  ComputationalCell ghost;
+  ghost.density = id.density_list.back();
+  ghost.velocity = Vector2D(0,0);
+  ghost.stickers["ghost"] = true;
   for(map<string,vector<double> >::const_iterator it=
 	id.tracers_list.begin();
       it!=id.tracers_list.end(); ++it)
-    tracer_intepolators[it->first] = new Interpolator(id.radius_mid,
-						      it->second);
-  for(size_t i=0;i<res.size();++i){
-    res.at(i).density = id.density_list.back();
-    res.at(i).velocity = Vector2D(0,0);
-    res.at(i).stickers["ghost"] = true;
-    for(map<string,Interpolator*>::const_iterator it=
-	  tracer_intepolators.begin();
-	it!=tracer_intepolators.end();
-	++it)
-      res.at(i).tracers[it->first] = 0;
-    res.at(i).tracers["He4"] = 1;
-    res.at(i).pressure = eos.dt2p(res.at(i).density,
-				  id.temperature_list.back(),
-				  res.at(i).tracers);
-    const Vector2D r = tess.GetCellCM(static_cast<int>(i));
-    const double radius = abs(r);
-    /*
-      if(radius<id.radius_list.front() || radius>id.radius_list.back())
-      continue;
-    */
+    ghost.tracers[it->first] = 0;
+  ghost.tracers["He4"] = 1;
+  ghost.pressure = eos.dt2p(ghost.density,
+			    id.temperature_list.back(),
+			    ghost.tracers);
+
+  // Interpolation of all profiles, independent for each cell
+  temperatures.assign(res.size(), id.temperature_list.back());
+  vector<pair<double,double> > aap(res.size());
+  vector<char> live(res.size(), 0);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for(int j=0;j<n;++j){
+    const size_t i = static_cast<size_t>(j);
+    ComputationalCell& cell = res[i];
+    cell = ghost;
+    const Vector2D r = tess.GetCellCM(j);
     if(!cd(r))
       continue;
-    res.at(i).stickers["ghost"] = false;
-    const double density = density_interpolator(radius);
-    const double temperature = temperature_interpolator(radius);
-    const double velocity = velocity_interpolator(radius);
-    for(map<string,Interpolator*>::const_iterator it=
-	  tracer_intepolators.begin();
-	it!=tracer_intepolators.end();
-	++it)
-      res.at(i).tracers[it->first] = (*(it->second))(radius);
-    const double pressure = eos.dt2p(density, temperature, res.at(i).tracers);
-    res.at(i).density = density;
-    res.at(i).pressure = pressure;
-    res.at(i).velocity = r*velocity/radius;
+    live[i] = 1;
+    const double radius = abs(r);
+    const Bracket mid(id.radius_mid, radius);
+    const Bracket edge(id.radius_list, radius);
+    cell.stickers["ghost"] = false;
+    cell.density = mid(id.density_list);
+    temperatures[i] = mid(id.temperature_list);
+    for(boost::container::flat_map<string,double>::iterator it=
+	  cell.tracers.begin();
+	it!=cell.tracers.end();
+	++it){
+      const map<string,vector<double> >::const_iterator profile =
+	id.tracers_list.find(it->first);
+      if(profile!=id.tracers_list.end())
+	it->second = mid(profile->second);
+    }
+    cell.velocity = r*edge(id.velocity_list)/radius;
+    aap[i] = eos.calcAverageAtomicProperties(cell.tracers);
+  }
+
+  // The tabulated equation of state is not reentrant
+  for(size_t i=0;i<res.size();++i){
+    if(live[i])
+      res[i].pressure = eos.dt2paz(res[i].density, temperatures[i], aap[i]);
   }
-  for(map<string,Interpolator*>::iterator it=
-	tracer_intepolators.begin();
-      it!=tracer_intepolators.end();
-      ++it)
-    delete it->second;
   return res;
 }
@@ -10,9 +10,18 @@
 
 using std::vector;
 
+/*! \brief Interpolates the initial profiles to the cells
+  \param tess Tessellation
+  \param eos Equation of state
+  \param id Initial profiles
+  \param cd Region of live cells
+  \param temperatures Temperature of each cell, output
+  \return Initial cells
+ */
 vector<ComputationalCell> calc_init_cond(const Tessellation& tess,
 					 const FermiTable& eos,
 					 const InitialData& id,
-					 const Shape2D& cd);
+					 const Shape2D& cd,
+					 vector<double>& temperatures);
 
 #endif // CALC_INIT_COND_HPP
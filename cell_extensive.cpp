@@ -0,0 +1,17 @@
+#include "cell_extensive.hpp"
+
+Extensive cell_extensive(const ComputationalCell& cell,
+			 double volume,
+			 double energy)
+{
+  Extensive res;
+  res.mass = volume*cell.density;
+  res.momentum = res.mass*cell.velocity;
+  res.energy = res.mass*(energy+0.5*ScalarProd(cell.velocity,cell.velocity));
+  for(boost::container::flat_map<string,double>::const_iterator it =
+	cell.tracers.begin();
+      it!=cell.tracers.end();
+      ++it)
+    res.tracers[it->first] = res.mass*it->second;
+  return res;
+}
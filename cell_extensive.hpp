@@ -0,0 +1,20 @@
+#ifndef CELL_EXTENSIVE_HPP
+#define CELL_EXTENSIVE_HPP 1
+
+#include "source/newtonian/two_dimensional/extensive.hpp"
+#include "source/newtonian/two_dimensional/computational_cell_2d.hpp"
+
+/*! \brief Conserved variables of one cell
+  \details The same as hdsim::recalculateExtensives, but the specific
+  thermal energy is given. Callers take it from the equation of state
+  cache, so no inversion is needed and all cells do not have to be redone.
+  \param cell Cell
+  \param volume Volume of the cell
+  \param energy Specific thermal energy
+  \return Conserved variables
+ */
+Extensive cell_extensive(const ComputationalCell& cell,
+			 double volume,
+			 double energy);
+
+#endif // CELL_EXTENSIVE_HPP
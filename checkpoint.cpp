@@ -0,0 +1,260 @@
+#include <csignal>
+#include <cstdio>
+#include "H5Cpp.h"
+#include "checkpoint.hpp"
+#include "wall_clock.hpp"
+#include "mpi_support.hpp"
+
+using namespace H5;
+
+namespace {
+
+  volatile sig_atomic_t termination_requested = 0;
+
+  extern "C" void request_termination(int /*signum*/)
+  {
+    termination_requested = 1;
+  }
+
+  template<class L> void write_doubles(L& location,
+				       const string& name,
+				       const vector<double>& data)
+  {
+    const hsize_t dims[1] = {static_cast<hsize_t>(data.size())};
+    DataSet dataset = location.createDataSet
+      (name, PredType::NATIVE_DOUBLE, DataSpace(1, dims));
+    if(!data.empty())
+      dataset.write(&data[0], PredType::NATIVE_DOUBLE);
+  }
+
+  template<class L> vector<double> read_doubles(const L& location,
+						const string& name)
+  {
+    const DataSet dataset = location.openDataSet(name);
+    hsize_t dims[1] = {0};
+    dataset.getSpace().getSimpleExtentDims(dims);
+    vector<double> res(static_cast<size_t>(dims[0]));
+    if(!res.empty())
+      dataset.read(&res[0], PredType::NATIVE_DOUBLE);
+    return res;
+  }
+
+  template<class T, class F> vector<double> collect
+  (const vector<T>& items, F T::* member)
+  {
+    vector<double> res(items.size());
+    for(size_t i=0;i<items.size();++i)
+      res[i] = items[i].*member;
+    return res;
+  }
+
+  template<class T, class F> void scatter
+  (const vector<double>& values, F T::* member, vector<T>& items)
+  {
+    assert(values.size()==items.size());
+    for(size_t i=0;i<items.size();++i)
+      items[i].*member = values[i];
+  }
+
+  template<class T> void write_tracers(Group group, const vector<T>& items)
+  {
+    if(items.empty())
+      return;
+    for(boost::container::flat_map<string,double>::const_iterator it=
+	  items.front().tracers.begin();
+	it!=items.front().tracers.end();
+	++it){
+      vector<double> values(items.size());
+      for(size_t i=0;i<items.size();++i)
+	values[i] = items[i].tracers.find(it->first)->second;
+      write_doubles(group, it->first, values);
+    }
+  }
+
+  template<class T> void read_tracers(const Group& group, vector<T>& items)
+  {
+    if(items.empty())
+      return;
+    for(boost::container::flat_map<string,double>::const_iterator it=
+	  items.front().tracers.begin();
+	it!=items.front().tracers.end();
+	++it){
+      const vector<double> values = read_doubles(group, it->first);
+      assert(values.size()==items.size());
+      for(size_t i=0;i<items.size();++i)
+	items[i].tracers[it->first] = values[i];
+    }
+  }
+}
+
+void write_checkpoint(const hdsim& sim,
+		      const map<string,double>& state,
+		      const map<string,vector<double> >& arrays,
+		      const string& fname)
+{
+  H5File file(fname, H5F_ACC_TRUNC);
+  write_doubles(file, "time", vector<double>(1,sim.getTime()));
+  write_doubles(file, "cycle", vector<double>(1,sim.getCycle()));
+
+  const vector<ComputationalCell>& cells = sim.getAllCells();
+  write_doubles(file, "density", collect(cells,&ComputationalCell::density));
+  write_doubles(file, "pressure",
+		collect(cells,&ComputationalCell::pressure));
+  vector<Vector2D> velocities(cells.size());
+  for(size_t i=0;i<cells.size();++i)
+    velocities[i] = cells[i].velocity;
+  write_doubles(file, "x_velocity", collect(velocities,&Vector2D::x));
+  write_doubles(file, "y_velocity", collect(velocities,&Vector2D::y));
+  write_tracers(file.createGroup("tracers"), cells);
+  if(!cells.empty()){
+    Group stickers = file.createGroup("stickers");
+    for(boost::container::flat_map<string,bool>::const_iterator it=
+	  cells.front().stickers.begin();
+	it!=cells.front().stickers.end();
+	++it){
+      vector<double> values(cells.size());
+      for(size_t i=0;i<cells.size();++i)
+	values[i] = cells[i].stickers.find(it->first)->second ? 1 : 0;
+      write_doubles(stickers, it->first, values);
+    }
+  }
+
+  const vector<Extensive>& extensives = sim.getAllExtensives();
+  write_doubles(file, "mass", collect(extensives,&Extensive::mass));
+  write_doubles(file, "energy", collect(extensives,&Extensive::energy));
+  vector<Vector2D> momenta(extensives.size());
+  for(size_t i=0;i<extensives.size();++i)
+    momenta[i] = extensives[i].momentum;
+  write_doubles(file, "x_momentum", collect(momenta,&Vector2D::x));
+  write_doubles(file, "y_momentum", collect(momenta,&Vector2D::y));
+  write_tracers(file.createGroup("extensive_tracers"), extensives);
+
+  string names;
+  vector<double> values;
+  for(map<string,double>::const_iterator it=state.begin();
+      it!=state.end();
+      ++it){
+    names += it->first + "\n";
+    values.push_back(it->second);
+  }
+  const StrType type(PredType::C_S1, names.empty() ? 1 : names.size());
+  file.createDataSet("state_names", type, DataSpace(H5S_SCALAR)).
+    write(names, type);
+  write_doubles(file, "state_values", values);
+  Group state_arrays = file.createGroup("state_arrays");
+  for(map<string,vector<double> >::const_iterator it=arrays.begin();
+      it!=arrays.end();
+      ++it)
+    write_doubles(state_arrays, it->first, it->second);
+}
+
+map<string,double> read_checkpoint(const string& fname,
+				   hdsim& sim,
+				   map<string,vector<double> >& arrays)
+{
+  const H5File file(fname, H5F_ACC_RDONLY);
+  sim.setStartTime(read_doubles(file, "time").front());
+  sim.setCycle(static_cast<int>(read_doubles(file, "cycle").front()));
+
+  vector<ComputationalCell>& cells = sim.getAllCells();
+  scatter(read_doubles(file, "density"),&ComputationalCell::density,cells);
+  scatter(read_doubles(file, "pressure"),&ComputationalCell::pressure,cells);
+  const vector<double> x_velocity = read_doubles(file, "x_velocity");
+  const vector<double> y_velocity = read_doubles(file, "y_velocity");
+  assert(x_velocity.size()==cells.size() && y_velocity.size()==cells.size());
+  for(size_t i=0;i<cells.size();++i)
+    cells[i].velocity = Vector2D(x_velocity[i], y_velocity[i]);
+  read_tracers(file.openGroup("tracers"), cells);
+  if(!cells.empty()){
+    const Group stickers = file.openGroup("stickers");
+    for(boost::container::flat_map<string,bool>::const_iterator it=
+	  cells.front().stickers.begin();
+	it!=cells.front().stickers.end();
+	++it){
+      const vector<double> values = read_doubles(stickers, it->first);
+      assert(values.size()==cells.size());
+      for(size_t i=0;i<cells.size();++i)
+	cells[i].stickers[it->first] = values[i]>0.5;
+    }
+  }
+
+  vector<Extensive>& extensives = sim.getAllExtensives();
+  scatter(read_doubles(file, "mass"),&Extensive::mass,extensives);
+  scatter(read_doubles(file, "energy"),&Extensive::energy,extensives);
+  const vector<double> x_momentum = read_doubles(file, "x_momentum");
+  const vector<double> y_momentum = read_doubles(file, "y_momentum");
+  assert(x_momentum.size()==extensives.size() &&
+	 y_momentum.size()==extensives.size());
+  for(size_t i=0;i<extensives.size();++i)
+    extensives[i].momentum = Vector2D(x_momentum[i], y_momentum[i]);
+  read_tracers(file.openGroup("extensive_tracers"), extensives);
+
+  string names;
+  const DataSet names_set = file.openDataSet("state_names");
+  names_set.read(names, names_set.getStrType());
+  const vector<double> values = read_doubles(file, "state_values");
+  map<string,double> res;
+  size_t begin = 0;
+  for(size_t i=0;i<values.size();++i){
+    const size_t end = names.find('\n', begin);
+    assert(end!=string::npos);
+    res[names.substr(begin, end-begin)] = values[i];
+    begin = end+1;
+  }
+  const Group state_arrays = file.openGroup("state_arrays");
+  for(hsize_t i=0;i<state_arrays.getNumObjs();++i){
+    const string name = state_arrays.getObjnameByIdx(i);
+    arrays[name] = read_doubles(state_arrays, name);
+  }
+  return res;
+}
+
+void install_termination_handler(void)
+{
+  signal(SIGTERM, request_termination);
+}
+
+CheckpointTermination::CheckpointTermination
+(TerminationCondition& inner,
+ const string& fname,
+ double interval,
+ const vector<CheckpointState*>& states):
+  inner_(inner),
+  fname_(fname),
+  interval_(interval),
+  states_(states),
+  last_(wall_clock()),
+  interrupted_(false) {}
+
+void CheckpointTermination::write(const hdsim& sim)
+{
+  map<string,double> state;
+  map<string,vector<double> > arrays;
+  for(size_t i=0;i<states_.size();++i){
+    states_[i]->saveState(state);
+    states_[i]->saveArrays(arrays);
+  }
+  const string temp_name = fname_ + ".tmp";
+  write_checkpoint(sim, state, arrays, temp_name);
+  if(rename(temp_name.c_str(), fname_.c_str())!=0)
+    throw "failed to rename " + temp_name;
+  last_ = wall_clock();
+}
+
+bool CheckpointTermination::operator()(const hdsim& sim)
+{
+  // Decided together, so all ranks stop or write at the same cycle
+  if(any_rank(termination_requested!=0)){
+    write(sim);
+    interrupted_ = true;
+    return false;
+  }
+  if(any_rank(wall_clock()-last_>=interval_))
+    write(sim);
+  return inner_(sim);
+}
+
+bool CheckpointTermination::interrupted(void) const
+{
+  return interrupted_;
+}
@@ -0,0 +1,77 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP 1
+
+#include <vector>
+#include "source/newtonian/test_2d/main_loop_2d.hpp"
+#include "checkpoint_state.hpp"
+
+using std::vector;
+
+/*! \brief Writes the cells, extensives, time, cycle and component state
+  \details All values are stored as native doubles, so a restart continues
+  bit for bit. The mesh is not stored, since it does not move.
+  \param sim Simulation
+  \param state Component state
+  \param arrays Per cell component state
+  \param fname Name of output file
+ */
+void write_checkpoint(const hdsim& sim,
+		      const map<string,double>& state,
+		      const map<string,vector<double> >& arrays,
+		      const string& fname);
+
+/*! \brief Overwrites the cells, extensives, time and cycle from a checkpoint
+  \param fname Name of checkpoint file
+  \param sim Simulation, built on the same mesh
+  \param arrays Per cell component state, output
+  \return Component state
+ */
+map<string,double> read_checkpoint(const string& fname,
+				   hdsim& sim,
+				   map<string,vector<double> >& arrays);
+
+//! \brief Makes SIGTERM request a checkpoint and a clean exit
+void install_termination_handler(void);
+
+/*! \brief Writes checkpoints at the start of a cycle
+  \details A checkpoint is written every few wall clock seconds, and when
+  SIGTERM was received, after which the run stops. Checking at the start of
+  the cycle means the manipulations and diagnostics of the previous cycle
+  have all run. The checkpoint is written to a temporary file and renamed,
+  so the last complete checkpoint always survives. In runs divided between
+  MPI ranks, a signal or an elapsed interval on any rank makes all of them
+  write, each in its own directory.
+ */
+class CheckpointTermination: public TerminationCondition
+{
+public:
+
+  /*! \brief Class constructor
+    \param inner Termination condition of the run
+    \param fname Name of checkpoint file
+    \param interval Wall clock seconds between checkpoints
+    \param states Components to save with the simulation
+   */
+  CheckpointTermination(TerminationCondition& inner,
+			const string& fname,
+			double interval,
+			const vector<CheckpointState*>& states);
+
+  bool operator()(const hdsim& sim);
+
+  //! \brief Writes a checkpoint now
+  void write(const hdsim& sim);
+
+  //! \brief Whether the run was stopped by SIGTERM rather than by the inner condition
+  bool interrupted(void) const;
+
+private:
+  TerminationCondition& inner_;
+  const string fname_;
+  const double interval_;
+  const vector<CheckpointState*> states_;
+  double last_;
+  bool interrupted_;
+};
+
+#endif // CHECKPOINT_HPP
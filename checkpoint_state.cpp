@@ -0,0 +1,8 @@
+#include "checkpoint_state.hpp"
+
+void CheckpointState::saveArrays(map<string,vector<double> >& /*arrays*/) {}
+
+void CheckpointState::loadArrays
+(const map<string,vector<double> >& /*arrays*/) {}
+
+CheckpointState::~CheckpointState(void) {}
@@ -0,0 +1,40 @@
+#ifndef CHECKPOINT_STATE_HPP
+#define CHECKPOINT_STATE_HPP 1
+
+#include <map>
+#include <string>
+#include <vector>
+
+using std::map;
+using std::string;
+using std::vector;
+
+//! \brief Component with state that has to survive a restart
+class CheckpointState
+{
+public:
+
+  /*! \brief Adds the state to a checkpoint
+    \param state Named values, shared by all components
+   */
+  virtual void saveState(map<string,double>& state) = 0;
+
+  /*! \brief Restores the state from a checkpoint, before the first cycle
+    \param state Named values, shared by all components
+   */
+  virtual void loadState(const map<string,double>& state) = 0;
+
+  /*! \brief Adds per cell state to a checkpoint. Does nothing by default
+    \param arrays Named arrays, shared by all components
+   */
+  virtual void saveArrays(map<string,vector<double> >& arrays);
+
+  /*! \brief Restores per cell state from a checkpoint. Does nothing by default
+    \param arrays Named arrays, shared by all components
+   */
+  virtual void loadArrays(const map<string,vector<double> >& arrays);
+
+  virtual ~CheckpointState(void);
+};
+
+#endif // CHECKPOINT_STATE_HPP
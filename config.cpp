@@ -0,0 +1,180 @@
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include "config.hpp"
+
+namespace {
+
+  string trim(const string& s)
+  {
+    const string blanks(" \t\r");
+    const size_t begin = s.find_first_not_of(blanks);
+    if(begin==string::npos)
+      return string();
+    return s.substr(begin, s.find_last_not_of(blanks)-begin+1);
+  }
+
+  pair<string,string> split_argument(const string& arg)
+  {
+    const size_t equal = arg.find('=');
+    if(equal==string::npos)
+      throw "expected key=value, got " + arg;
+    return pair<string,string>(trim(arg.substr(0,equal)),
+			       trim(arg.substr(equal+1)));
+  }
+
+  template<class T> string to_string(const T& value)
+  {
+    std::ostringstream ss;
+    ss.precision(17);
+    ss << value;
+    return ss.str();
+  }
+}
+
+Config::Config(int argc, const char* const* argv):
+  values_(), used_()
+{
+  map<string,string> overrides;
+  for(int i=1;i<argc;++i){
+    const pair<string,string> item = split_argument(argv[i]);
+    overrides[item.first] = item.second;
+  }
+  const map<string,string>::const_iterator config_file =
+    overrides.find("config");
+  if(config_file!=overrides.end()){
+    std::ifstream f(config_file->second.c_str());
+    if(!f)
+      throw "failed to open " + config_file->second;
+    string line;
+    for(int line_number=1;std::getline(f,line);++line_number)
+      parseLine(line, config_file->second+":"+to_string(line_number));
+    used_["config"] = config_file->second;
+  }
+  for(map<string,string>::const_iterator it=overrides.begin();
+      it!=overrides.end();
+      ++it)
+    values_[it->first] = it->second;
+}
+
+Config::Config(const Config& base, const vector<string>& overrides):
+  values_(base.values_), used_(base.used_)
+{
+  for(size_t i=0;i<overrides.size();++i){
+    const pair<string,string> item = split_argument(overrides[i]);
+    if(used_.count(item.first)>0 || item.first=="config")
+      throw item.first + " is shared by all runs and cannot be overridden";
+    values_[item.first] = item.second;
+  }
+}
+
+void Config::parseLine(const string& line, const string& source)
+{
+  const string content = trim(line.substr(0,line.find('#')));
+  if(content.empty())
+    return;
+  const size_t equal = content.find('=');
+  if(equal==string::npos)
+    throw source + ": expected key=value";
+  values_[trim(content.substr(0,equal))] = trim(content.substr(equal+1));
+}
+
+const string* Config::find(const string& key) const
+{
+  const map<string,string>::const_iterator it = values_.find(key);
+  return it==values_.end() ? 0 : &it->second;
+}
+
+string Config::getString(const string& key, const string& fallback) const
+{
+  const string* value = find(key);
+  const string res = value ? *value : fallback;
+  used_[key] = res;
+  return res;
+}
+
+double Config::getDouble(const string& key, double fallback) const
+{
+  const string* value = find(key);
+  double res = fallback;
+  if(value){
+    char* end = 0;
+    res = strtod(value->c_str(), &end);
+    if(value->empty() || *end!='\0')
+      throw key + ": expected a number, got " + *value;
+  }
+  used_[key] = to_string(res);
+  return res;
+}
+
+int Config::getInt(const string& key, int fallback) const
+{
+  const string* value = find(key);
+  int res = fallback;
+  if(value){
+    char* end = 0;
+    const long buf = strtol(value->c_str(), &end, 10);
+    if(value->empty() || *end!='\0')
+      throw key + ": expected an integer, got " + *value;
+    res = static_cast<int>(buf);
+  }
+  used_[key] = to_string(res);
+  return res;
+}
+
+size_t Config::getSize(const string& key, size_t fallback) const
+{
+  const int res = getInt(key, static_cast<int>(fallback));
+  if(res<0)
+    throw key + ": expected a non negative integer, got " + *find(key);
+  return static_cast<size_t>(res);
+}
+
+bool Config::getBool(const string& key, bool fallback) const
+{
+  const string* value = find(key);
+  bool res = fallback;
+  if(value){
+    if(*value=="1" || *value=="true")
+      res = true;
+    else if(*value=="0" || *value=="false")
+      res = false;
+    else
+      throw key + ": expected true or false, got " + *value;
+  }
+  used_[key] = res ? "true" : "false";
+  return res;
+}
+
+vector<string> Config::getList(const string& key) const
+{
+  const string value = getString(key, "");
+  vector<string> res;
+  std::istringstream ss(value);
+  string item;
+  while(std::getline(ss, item, ',')){
+    item = trim(item);
+    if(!item.empty())
+      res.push_back(item);
+  }
+  return res;
+}
+
+void Config::checkUnused(void) const
+{
+  for(map<string,string>::const_iterator it=values_.begin();
+      it!=values_.end();
+      ++it){
+    if(used_.count(it->first)==0)
+      throw "unknown configuration key " + it->first;
+  }
+}
+
+void Config::write(const string& fname) const
+{
+  std::ofstream f(fname.c_str());
+  for(map<string,string>::const_iterator it=used_.begin();
+      it!=used_.end();
+      ++it)
+    f << it->first << " = " << it->second << "\n";
+}
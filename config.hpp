@@ -0,0 +1,75 @@
+#ifndef CONFIG_HPP
+#define CONFIG_HPP 1
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+using std::map;
+using std::string;
+using std::vector;
+using std::pair;
+using std::size_t;
+
+/*! \brief Run parameters, read from a key=value file and the command line
+  \details Each line of the file holds one key=value pair, and anything
+  after # is ignored. Command line arguments of the form key=value override
+  the file. Every getter takes a default, used when the key is absent. Keys
+  that are set but never read are reported by checkUnused, which catches
+  misspelled keys.
+ */
+class Config
+{
+public:
+
+  /*! \brief Class constructor
+    \param argc Number of command line arguments
+    \param argv Command line arguments. The file is given by config=<name>, and is optional
+   */
+  Config(int argc, const char* const* argv);
+
+  /*! \brief Copy of a configuration with more overrides
+    \details Keys that were already read from the base configuration are shared, and cannot be overridden
+    \param base Base configuration
+    \param overrides Arguments of the form key=value
+   */
+  Config(const Config& base, const vector<string>& overrides);
+
+  string getString(const string& key, const string& fallback) const;
+
+  double getDouble(const string& key, double fallback) const;
+
+  int getInt(const string& key, int fallback) const;
+
+  //! \brief Integer that must not be negative, for sizes and counts
+  size_t getSize(const string& key, size_t fallback) const;
+
+  bool getBool(const string& key, bool fallback) const;
+
+  /*! \brief Comma separated list
+    \param key Key
+    \return Items, empty if the key is absent
+   */
+  vector<string> getList(const string& key) const;
+
+  //! \brief Throws if a key was set but never read
+  void checkUnused(void) const;
+
+  /*! \brief Writes every key that was read, with the value used
+    \param fname Name of output file
+   */
+  void write(const string& fname) const;
+
+private:
+  map<string,string> values_;
+  mutable map<string,string> used_;
+
+  void parseLine(const string& line, const string& source);
+
+  Config& operator=(const Config&);
+
+  const string* find(const string& key) const;
+};
+
+#endif // CONFIG_HPP
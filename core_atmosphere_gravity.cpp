@@ -1,4 +1,6 @@
 #include "core_atmosphere_gravity.hpp"
+#include "angular_decomposition.hpp"
+#include "mpi_support.hpp"
 
 namespace {
   vector<pair<double,double> > calc_mass_radius_list
@@ -8,7 +10,7 @@ namespace {
   {
     vector<pair<double, double> > res;
     for(size_t i=0;i<cells.size();++i){
-      if(cells[i].stickers.find("ghost")->second)
+      if(cells[i].stickers.find("ghost")->second || is_halo(cells[i]))
 	continue;
       const double radius = abs(tess.GetCellCM(static_cast<int>(i)));
       const double mass = cd.volumes[i]*cells[i].density;
@@ -65,8 +67,8 @@ CoreAtmosphereGravity::EnclosedMassCalculator::EnclosedMassCalculator
    (core_mass,
     mult_all
     (section2shell,
-     calc_mass_in_shells(mass_radius_list,
-			 sample_radii)))) {}
+     global_sum(calc_mass_in_shells(mass_radius_list,
+				    sample_radii))))) {}
 
 double CoreAtmosphereGravity::EnclosedMassCalculator::operator()
   (double radius) const
@@ -91,12 +93,15 @@ CoreAtmosphereGravity::CoreAtmosphereGravity
 (const double core_mass,
  const vector<double>& sample_radii,
  const double gravitation_constant,
- const pair<double,double>& sector_angles):
+ const pair<double,double>& sector_angles,
+ PhaseProfiler& prof):
   core_mass_(core_mass),
   sample_radii_(sample_radii),
   gravitation_constant_(gravitation_constant),
   section2shell_
-  (2./(cos(sector_angles.first)-cos(sector_angles.second))) {}
+  (2./(cos(sector_angles.first)-cos(sector_angles.second))),
+  prof_(prof),
+  phase_(prof.addPhase("gravity")) {}
 
 vector<Extensive> CoreAtmosphereGravity::operator()
   (const Tessellation& tess,
@@ -107,6 +112,7 @@ vector<Extensive> CoreAtmosphereGravity::operator()
    const vector<Vector2D>& /*point_velocities*/,
    const double /*time*/) const
 {
+  const PhaseProfiler::ScopedTimer timer(prof_, phase_);
   const EnclosedMassCalculator emc
     (core_mass_,
      calc_mass_radius_list
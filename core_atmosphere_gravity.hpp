@@ -3,6 +3,7 @@
 
 #include "source/newtonian/two_dimensional/SourceTerm.hpp"
 #include "interpolator.hpp"
+#include "phase_profiler.hpp"
 
 using std::vector;
 
@@ -10,6 +11,11 @@ class CoreAtmosphereGravity: public SourceTerm
 {
 public:
 
+  /*! \brief Enclosed mass profile. Immutable once built, so threads may share it
+    \details The shell masses are summed over all MPI ranks, so every rank
+    builds one at the same point of the cycle. Halo cells are left out of
+    the list, since their owners count them.
+   */
   class EnclosedMassCalculator
   {
   public:
@@ -26,6 +32,10 @@ public:
     const Interpolator interpolator_;
   };
 
+  /*! \brief Gravitational acceleration
+    \details Holds no scratch state, so concurrent calls are safe as long as
+    the enclosed mass calculator outlives them
+   */
   class AccelerationCalculator
   {
   public:
@@ -44,7 +54,8 @@ public:
   (const double core_mass,
    const vector<double>& sample_radii,
    const double gravitation_constant,
-   const pair<double,double>& sector_angles);
+   const pair<double,double>& sector_angles,
+   PhaseProfiler& prof);
 
   vector<Extensive> operator()
   (const Tessellation& tess,
@@ -68,6 +79,8 @@ private:
    const vector<double> sample_radii_;
    const double gravitation_constant_;
    const double section2shell_;
+   PhaseProfiler& prof_;
+   const size_t phase_;
 };
 
 #endif // CORE_ATMOSPHERE_GRAVITY_HPP
@@ -1,31 +1,81 @@
+#include <algorithm>
 #include <cmath>
-#include <fstream>
+#include <iostream>
 #include "create_grid.hpp"
 #include "rectangle_stretch.hpp"
 #include "source/tessellation/right_rectangle.hpp"
 #include "source/newtonian/test_2d/clip_grid.hpp"
 
-using std::ofstream;
-using std::endl;
+namespace {
 
-vector<Vector2D> create_grid(const pair<Vector2D,Vector2D>& boundaries,
-			     const double dq,
-			     const double r_min)
+  double local_spacing(double radius,
+		       double dq,
+		       const vector<RefinementBand>& bands)
+  {
+    double res = dq;
+    for(size_t i=0;i<bands.size();++i){
+      if(bands[i].contains(radius))
+	res = std::min(res, dq/bands[i].factor);
+    }
+    return res;
+  }
+
+  void add_shell(double radius_low,
+		 double radius_high,
+		 const pair<double,double>& angles,
+		 size_t halo,
+		 vector<Vector2D>& res)
+  {
+    const double radius = sqrt(radius_low*radius_high);
+    const double width = angles.second - angles.first;
+    const size_t n = static_cast<size_t>
+      (std::max(1.0,ceil(width*radius/(radius_high-radius_low))));
+    const double dq = width/static_cast<double>(n);
+    for(size_t j=0;j<n+2*halo;++j){
+      const double q = angles.first +
+	(static_cast<double>(j)-static_cast<double>(halo)+0.5)*dq;
+      res.push_back(Vector2D(radius*cos(q),radius*sin(q)));
+    }
+  }
+}
+
+vector<Vector2D> create_grid(const CircularSection& domain,
+			     const pair<Vector2D,Vector2D>& boundaries,
+			     double dq,
+			     const vector<RefinementBand>& bands,
+			     size_t halo)
 {
+  const pair<double,double> radii = domain.getRadii();
+  const pair<double,double> angles = domain.getAngles();
   vector<Vector2D> res;
-  //   const double r_min = 0.1*boundaries.first.y;
-  const double r_max = boundaries.second.y;
-  for(double r=r_min;
-      r<r_max;
-      r*=(1+dq)){
-    for(double q=0;q<2*M_PI;q+=dq)
-      res.push_back(Vector2D(r*cos(q),r*sin(q)));
+
+  // Inner halo, continuing the spacing at the inner edge inwards
+  double radius = radii.first;
+  for(size_t i=0;i<halo;++i){
+    const double lower = radius/(1+local_spacing(radius,dq,bands));
+    add_shell(lower, radius, angles, halo, res);
+    radius = lower;
+  }
+  // Live shells, then the outer halo
+  radius = radii.first;
+  while(radius<radii.second){
+    const double upper = radius*(1+local_spacing(radius,dq,bands));
+    add_shell(radius, upper, angles, halo, res);
+    radius = upper;
+  }
+  for(size_t i=0;i<halo;++i){
+    const double upper = radius*(1+local_spacing(radius,dq,bands));
+    add_shell(radius, upper, angles, halo, res);
+    radius = upper;
+  }
+  res = clip_grid(RightRectangle(rectangle_stretch(boundaries,0.99)),res);
+
+  size_t live = 0;
+  for(size_t i=0;i<res.size();++i){
+    if(domain(res[i]))
+      ++live;
   }
-  //    res = rectangular_clip(res,rectangle_stretch(boundaries,0.99));
-  res = clip_grid (RightRectangle(rectangle_stretch(boundaries,0.99)),res);
-  ofstream f("mesh_points.txt");
-  for(size_t i=0;i<res.size();++i)
-    f << res.at(i).x << " " << res.at(i).y << endl;
-  f.close();
+  std::cout << "mesh: " << live << " live, "
+	    << res.size()-live << " ghost points" << std::endl;
   return res;
 }
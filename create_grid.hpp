@@ -3,12 +3,30 @@
 
 #include <vector>
 #include "source/tessellation/geometry.hpp"
+#include "circular_section.hpp"
+#include "refinement_band.hpp"
 
 using std::vector;
 using std::pair;
 
-vector<Vector2D> create_grid(const pair<Vector2D,Vector2D>& boundaries,
-			     const double dq,
-			     const double r_min);
+/*! \brief Polar mesh points covering a wedge, plus a thin ghost halo
+  \details Shells are spaced logarithmically, with relative width dq, or
+  dq divided by the factor of the refinement band the shell starts in. Each
+  shell has points at roughly the same angular spacing, centred so the
+  wedge edges fall between points, and halo points continue the pattern for
+  a few shells and angles beyond the wedge. Points outside the boundaries
+  are dropped. The number of live and ghost points is printed.
+  \param domain Wedge of live cells
+  \param boundaries Lower left and upper right corners of the computational box
+  \param dq Relative radial spacing, also the angular spacing
+  \param bands Refinement bands
+  \param halo Number of ghost points beyond each edge of the wedge
+  \return Mesh generating points
+ */
+vector<Vector2D> create_grid(const CircularSection& domain,
+			     const pair<Vector2D,Vector2D>& boundaries,
+			     double dq,
+			     const vector<RefinementBand>& bands,
+			     size_t halo);
 
 #endif // CREATE_GRID_HPP
@@ -0,0 +1,130 @@
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include "diagnostics_sink.hpp"
+#include "wall_clock.hpp"
+
+DiagnosticsSink::DiagnosticsSink(const string& fname,
+				 bool binary,
+				 char separator,
+				 size_t flush_rows,
+				 double sync_interval):
+  fname_(fname),
+  binary_(binary),
+  separator_(separator),
+  flush_rows_(flush_rows),
+  sync_interval_(sync_interval),
+  fd_(open(fname.c_str(),O_WRONLY|O_CREAT|O_APPEND,0644)),
+  buffer_(),
+  buffered_rows_(0),
+  columns_(0),
+  last_sync_(wall_clock()),
+  offset_(0),
+  truncated_(false)
+{
+  if(fd_<0)
+    throw "failed to open " + fname_;
+}
+
+void DiagnosticsSink::writeHeader(const vector<string>& columns)
+{
+  assert(columns_==0 && buffered_rows_==0);
+  columns_ = columns.size();
+  if(binary_){
+    std::ofstream f((fname_+".columns").c_str());
+    for(size_t i=0;i<columns.size();++i)
+      f << columns[i] << "\n";
+    return;
+  }
+  for(size_t i=0;i<columns.size();++i){
+    if(i>0)
+      buffer_ += separator_;
+    buffer_ += columns[i];
+  }
+  buffer_ += '\n';
+}
+
+void DiagnosticsSink::writeRow(const vector<double>& row)
+{
+  if(columns_==0)
+    columns_ = row.size();
+  assert(row.size()==columns_);
+  if(binary_)
+    buffer_.append(reinterpret_cast<const char*>(&row[0]),
+		   row.size()*sizeof(double));
+  else{
+    char buf[32];
+    for(size_t i=0;i<row.size();++i){
+      if(i>0)
+	buffer_ += separator_;
+      sprintf(buf,"%.10g",row[i]);
+      buffer_ += buf;
+    }
+    buffer_ += '\n';
+  }
+  ++buffered_rows_;
+  if(buffered_rows_>=flush_rows_)
+    flush();
+  if(wall_clock()-last_sync_>=sync_interval_)
+    sync();
+}
+
+void DiagnosticsSink::flush(void)
+{
+  if(!truncated_){
+    if(ftruncate(fd_,static_cast<off_t>(offset_))!=0)
+      throw "failed to truncate " + fname_;
+    truncated_ = true;
+  }
+  size_t written = 0;
+  while(written<buffer_.size()){
+    const ssize_t n = write(fd_,
+			    buffer_.data()+written,
+			    buffer_.size()-written);
+    if(n<0)
+      throw "failed to write " + fname_;
+    written += static_cast<size_t>(n);
+  }
+  offset_ += buffer_.size();
+  buffer_.clear();
+  buffered_rows_ = 0;
+}
+
+void DiagnosticsSink::sync(void)
+{
+  flush();
+  fsync(fd_);
+  last_sync_ = wall_clock();
+}
+
+size_t DiagnosticsSink::getOffset(void)
+{
+  flush();
+  return offset_;
+}
+
+void DiagnosticsSink::saveState(map<string,double>& state)
+{
+  sync();
+  state["sink "+fname_] = static_cast<double>(offset_);
+}
+
+void DiagnosticsSink::loadState(const map<string,double>& state)
+{
+  assert(!truncated_ && buffer_.empty());
+  const map<string,double>::const_iterator it =
+    state.find("sink "+fname_);
+  if(it!=state.end())
+    offset_ = static_cast<size_t>(it->second);
+}
+
+DiagnosticsSink::~DiagnosticsSink(void)
+{
+  try{
+    sync();
+  }
+  catch(const string&){}
+  close(fd_);
+}
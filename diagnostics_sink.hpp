@@ -0,0 +1,81 @@
+#ifndef DIAGNOSTICS_SINK_HPP
+#define DIAGNOSTICS_SINK_HPP 1
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include "checkpoint_state.hpp"
+
+using std::vector;
+using std::string;
+using std::size_t;
+
+/*! \brief Buffered, append only output for time series
+  \details Rows are kept in memory and written every few rows, and the
+  file is synced to disk at a fixed wall clock interval, so a killed run
+  loses at most the rows since the last flush. In binary mode the rows are
+  native doubles, and the column names go to a text file with the suffix
+  ".columns". The file is truncated on the first write, to the offset
+  restored from a checkpoint if there is one.
+ */
+class DiagnosticsSink: public CheckpointState
+{
+public:
+
+  /*! \brief Class constructor
+    \param fname Name of output file
+    \param binary Write raw doubles instead of text
+    \param separator Column separator in text mode
+    \param flush_rows Number of rows kept in memory before writing
+    \param sync_interval Wall clock seconds between syncs to disk
+   */
+  explicit DiagnosticsSink(const string& fname,
+			   bool binary=false,
+			   char separator=' ',
+			   size_t flush_rows=64,
+			   double sync_interval=60);
+
+  /*! \brief Writes the column names. Optional, and only before the first row
+    \param columns Column names
+   */
+  void writeHeader(const vector<string>& columns);
+
+  /*! \brief Appends a row
+    \param row Values, same number in every row
+   */
+  void writeRow(const vector<double>& row);
+
+  //! \brief Writes the buffered rows to the file
+  void flush(void);
+
+  //! \brief Writes the buffered rows and syncs the file to disk
+  void sync(void);
+
+  //! \brief Number of bytes in the file, after the buffered rows are written
+  size_t getOffset(void);
+
+  void saveState(map<string,double>& state);
+
+  void loadState(const map<string,double>& state);
+
+  ~DiagnosticsSink(void);
+
+private:
+  const string fname_;
+  const bool binary_;
+  const char separator_;
+  const size_t flush_rows_;
+  const double sync_interval_;
+  const int fd_;
+  string buffer_;
+  size_t buffered_rows_;
+  size_t columns_;
+  double last_sync_;
+  size_t offset_;
+  bool truncated_;
+
+  DiagnosticsSink(const DiagnosticsSink&);
+  DiagnosticsSink& operator=(const DiagnosticsSink&);
+};
+
+#endif // DIAGNOSTICS_SINK_HPP
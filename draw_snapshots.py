@@ -1,3 +1,45 @@
+import functools
+
+def geometry_path(f, in_file):
+    """
+    Snapshots written with a shared geometry refer to
+    a mesh file for the cell vertices
+    """
+
+    import os
+
+    if 'geometry_file' not in f.attrs:
+        return in_file
+    fname = f.attrs['geometry_file']
+    if isinstance(fname, bytes):
+        fname = fname.decode()
+    return os.path.join(os.path.dirname(in_file), fname)
+
+@functools.lru_cache(maxsize=4)
+def load_polygons(path):
+    """
+    Polygons of the live cells, loaded once per geometry file
+    """
+
+    import numpy
+    import h5py
+
+    with h5py.File(path, 'r') as g:
+        vert_idx_list = numpy.concatenate(([0],
+                                           numpy.cumsum(g['Number of vertices in cell'])))
+        x_verts = numpy.array(g['x position of vertices'])
+        y_verts = numpy.array(g['y position of vertices'])
+        ghost_list = numpy.array(g['ghost'])
+    verts = []
+    for i in range(len(ghost_list)):
+        if ghost_list[i]<0.5:
+            lowbound = int(vert_idx_list[i])
+            upbound = int(vert_idx_list[i+1])
+            verts.append([[x,y] for x,y
+                          in zip(x_verts[lowbound:upbound],
+                                 y_verts[lowbound:upbound])])
+    return verts
+
 def plot_single(in_file, zfunc, zname, out_file):
 
     import pylab
@@ -13,19 +55,7 @@ def plot_single(in_file, zfunc, zname, out_file):
         return
 
     with h5py.File(in_file,'r+') as f:
-        vert_idx_list = numpy.concatenate(([0],
-                                           numpy.cumsum(f['Number of vertices in cell'])))
-        verts = []
-        x_verts = numpy.array(f['x position of vertices'])
-        y_verts = numpy.array(f['y position of vertices'])
-        ghost_list = numpy.array(f['ghost'])
-        for i in range(len(f['density'])):
-            if ghost_list[i]<0.5:
-                lowbound = int(vert_idx_list[i])
-                upbound = int(vert_idx_list[i+1])
-                verts.append([[x,y] for x,y
-                              in zip(x_verts[lowbound:upbound],
-                                     y_verts[lowbound:upbound])])
+        verts = load_polygons(geometry_path(f, in_file))
         coll = PolyCollection(verts, 
                               array=zfunc(f),
                               cmap = mpl.cm.jet,
@@ -0,0 +1,230 @@
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+#include "electron_table.hpp"
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+namespace {
+  // Constants as in rho_tmp.f90
+  const double avogadro = 6.025e23;
+  const double boltz = 1.380662e-16;
+  const double gascon = avogadro*boltz;
+  const double eps = 1e-5;
+
+  // Cubic interpolation coefficients, cinterp in tables_module.f90
+  const double cinterp[4][4] =
+    {{0, -0.5, 1, -0.5},
+     {1, 0, -2.5, 1.5},
+     {0, 0.5, 2, -1.5},
+     {0, 0, -0.5, 0.5}};
+
+  const size_t node_width = 4;
+
+  vector<double> interleave(const EosTables& tables)
+  {
+    const vector<double>& etab = tables.getETab();
+    const vector<double>& ptab = tables.getPTab();
+    const vector<double>& efer = tables.getEFer();
+    vector<double> res(node_width*etab.size(), 0);
+    for(size_t i=0;i<etab.size();++i){
+      res[node_width*i] = etab[i];
+      res[node_width*i+1] = ptab[i];
+      res[node_width*i+2] = efer[i];
+    }
+    return res;
+  }
+
+  /* Weights of the four stencil nodes and their derivatives, for a
+     position s in [0,1] between the middle two. The powers follow
+     rho_tmp.f90 so the results agree to round off. */
+  void calc_weights(double s, double w[4], double dw[4])
+  {
+    double sp[4] = {1, 0, 0, 0};
+    double dsp[4] = {0, 1, 0, 0};
+    if(s>0){
+      sp[1] = s;
+      sp[2] = s*s;
+      sp[3] = s*s*s;
+      dsp[2] = 2*sp[2]/s;
+      dsp[3] = 3*sp[3]/s;
+    }
+    for(size_t i=0;i<4;++i){
+      w[i] = 0;
+      dw[i] = 0;
+      for(size_t k=0;k<4;++k){
+	w[i] += cinterp[i][k]*sp[k];
+	dw[i] += cinterp[i][k]*dsp[k];
+      }
+    }
+  }
+
+  /* Sums the stencil starting at node, for all three tables at once.
+     sums receives the values, s derivatives and t derivatives, four
+     lanes each (energy, pressure, Fermi, padding). */
+  void stencil_sum(const double* node,
+		   size_t row_stride,
+		   const double as[4],
+		   const double das[4],
+		   const double at[4],
+		   const double dat[4],
+		   double sums[12])
+  {
+#ifdef __AVX__
+    __m256d value = _mm256_setzero_pd();
+    __m256d ds = _mm256_setzero_pd();
+    __m256d dt = _mm256_setzero_pd();
+    for(size_t i=0;i<4;++i){
+      for(size_t j=0;j<4;++j){
+	const __m256d entry =
+	  _mm256_loadu_pd(node+node_width*i+row_stride*j);
+	value = _mm256_add_pd
+	  (value, _mm256_mul_pd(_mm256_set1_pd(as[i]*at[j]), entry));
+	ds = _mm256_add_pd
+	  (ds, _mm256_mul_pd(_mm256_set1_pd(das[i]*at[j]), entry));
+	dt = _mm256_add_pd
+	  (dt, _mm256_mul_pd(_mm256_set1_pd(dat[j]*as[i]), entry));
+      }
+    }
+    _mm256_storeu_pd(sums, value);
+    _mm256_storeu_pd(sums+4, ds);
+    _mm256_storeu_pd(sums+8, dt);
+#else
+    std::fill(sums, sums+12, 0);
+    for(size_t i=0;i<4;++i){
+      for(size_t j=0;j<4;++j){
+	const double* entry = node+node_width*i+row_stride*j;
+	const double w = as[i]*at[j];
+	const double ws = das[i]*at[j];
+	const double wt = dat[j]*as[i];
+	for(size_t k=0;k<3;++k){
+	  sums[k] += w*entry[k];
+	  sums[4+k] += ws*entry[k];
+	  sums[8+k] += wt*entry[k];
+	}
+      }
+    }
+#endif
+  }
+
+  /* Index of the first stencil node and the position within the middle
+     interval, clamped the same way as rho_tmp.f90 */
+  size_t locate(double x, double x0, double dx, size_t n, double& s)
+  {
+    const int last = static_cast<int>(n) - 1;
+    int ii = std::min(static_cast<int>(std::floor((x-x0)/dx))+2, last);
+    ii = std::min(std::max(ii,3), last);
+    s = (x-(x0+(ii-2)*dx))/dx;
+    s = std::max(0.0, std::min(s, 1.0));
+    return static_cast<size_t>(ii-3);
+  }
+}
+
+ElectronTable::Batch::Batch(size_t n):
+  energy(n),
+  pressure(n),
+  entropy(n),
+  fermi(n),
+  de_drho(n),
+  de_dtmp(n),
+  dp_drho(n),
+  dp_dtmp(n) {}
+
+void ElectronTable::Batch::resize(size_t n)
+{
+  energy.resize(n);
+  pressure.resize(n);
+  entropy.resize(n);
+  fermi.resize(n);
+  de_drho.resize(n);
+  de_dtmp.resize(n);
+  dp_drho.resize(n);
+  dp_dtmp.resize(n);
+}
+
+ElectronTable::ElectronTable(const EosTables& tables):
+  itab_(tables.getXTab().size()),
+  jtab_(tables.getYTab().size()),
+  x0_(tables.getXTab().front()),
+  y0_(tables.getYTab().front()),
+  dx_(tables.getDXTab()),
+  dy_(tables.getDYTab()),
+  x_gas_(tables.getXTab()[1]),
+  x_min_(tables.getXTab()[1]+eps*tables.getDXTab()),
+  x_max_(tables.getXTab()[itab_-2]),
+  y_min_(tables.getYTab()[1]+eps*tables.getDYTab()),
+  y_max_(tables.getYTab()[jtab_-2]),
+  nodes_(interleave(tables)) {}
+
+void ElectronTable::operator()(const vector<double>& density,
+			       const vector<double>& ye,
+			       const vector<double>& temperature,
+			       Batch& res) const
+{
+  assert(ye.size()==density.size());
+  assert(temperature.size()==density.size());
+  res.resize(density.size());
+  for(size_t i=0;i<density.size();++i)
+    evaluate(i, density[i], ye[i], temperature[i], res);
+}
+
+void ElectronTable::evaluate(size_t index,
+			     double rho,
+			     double ye,
+			     double tmp,
+			     Batch& res) const
+{
+  const double roe = rho*ye;
+  const double log_roe = std::log(roe);
+  if(log_roe<=x_gas_){
+    const double ptabl = gascon*roe*tmp;
+    const double etabl = 1.5*ptabl;
+    res.energy[index] = etabl;
+    res.pressure[index] = ptabl;
+    res.entropy[index] = 0;
+    res.fermi[index] = 0;
+    res.de_drho[index] = etabl/rho;
+    res.de_dtmp[index] = etabl/tmp;
+    res.dp_drho[index] = ptabl/rho;
+    res.dp_dtmp[index] = ptabl/tmp;
+    return;
+  }
+  const double x = std::min(std::max(log_roe, x_min_), x_max_);
+  const double y = std::min(std::max(std::log(tmp), y_min_), y_max_);
+  double s = 0;
+  double t = 0;
+  const size_t i0 = locate(x, x0_, dx_, itab_, s);
+  const size_t j0 = locate(y, y0_, dy_, jtab_, t);
+  double as[4], das[4], at[4], dat[4];
+  calc_weights(s, as, das);
+  calc_weights(t, at, dat);
+  double sums[12];
+  stencil_sum(&nodes_[node_width*(j0*itab_+i0)],
+	      node_width*itab_,
+	      as, das, at, dat,
+	      sums);
+  const double px = sums[1];
+  const double efx = sums[2];
+  const double etabl = std::exp(sums[0]);
+  const double detdrho = etabl/rho*sums[4]/dx_;
+  const double detdtmp = etabl/tmp*sums[8]/dy_;
+  const double ptabl = px*etabl;
+  res.energy[index] = etabl;
+  res.pressure[index] = ptabl;
+  res.entropy[index] = (etabl+ptabl)/tmp - gascon*efx*roe;
+  res.fermi[index] = efx;
+  res.de_drho[index] = detdrho;
+  res.de_dtmp[index] = detdtmp;
+  res.dp_drho[index] = px*detdrho+etabl/rho*sums[5]/dx_;
+  res.dp_dtmp[index] = px*detdtmp+etabl/tmp*sums[9]/dy_;
+}
+
+const char* ElectronTable::getInstructionSet(void)
+{
+#ifdef __AVX__
+  return "avx";
+#else
+  return "scalar";
+#endif
+}
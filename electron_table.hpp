@@ -0,0 +1,95 @@
+#ifndef ELECTRON_TABLE_HPP
+#define ELECTRON_TABLE_HPP 1
+
+#include <vector>
+#include <cstddef>
+#include "eos_tables.hpp"
+
+using std::vector;
+using std::size_t;
+
+/*! \brief Batched interpolation of the tabulated electron equation of state
+  \details Evaluates the same bicubic interpolation and derivatives as
+  rho_tmp.f90, for many points at a time. The energy, pressure and Fermi
+  tables are interleaved per grid node, padded to four doubles, so the
+  4x4 stencil of a point is sixteen contiguous 32 byte loads that one AVX
+  register accumulates all three tables from. Builds without AVX use a
+  scalar loop over the same layout.
+ */
+class ElectronTable
+{
+public:
+
+  //! \brief Electron contributions for a batch of points
+  class Batch
+  {
+  public:
+
+    explicit Batch(size_t n=0);
+
+    void resize(size_t n);
+
+    //! \brief Energy per unit volume
+    vector<double> energy;
+
+    vector<double> pressure;
+
+    //! \brief Entropy per unit volume
+    vector<double> entropy;
+
+    //! \brief Chemical potential term, xfermi in the Fortran
+    vector<double> fermi;
+
+    vector<double> de_drho;
+
+    vector<double> de_dtmp;
+
+    vector<double> dp_drho;
+
+    vector<double> dp_dtmp;
+  };
+
+  /*! \brief Class constructor
+    \param tables Loaded tables
+   */
+  explicit ElectronTable(const EosTables& tables);
+
+  /*! \brief Evaluates a batch of points
+    \param density Mass density
+    \param ye Electron fraction, Z/A
+    \param temperature Temperature
+    \param res Electron contributions, resized to the batch
+   */
+  void operator()(const vector<double>& density,
+		  const vector<double>& ye,
+		  const vector<double>& temperature,
+		  Batch& res) const;
+
+  //! \brief Instruction set of the stencil sums
+  static const char* getInstructionSet(void);
+
+private:
+
+  void evaluate(size_t index,
+		double density,
+		double ye,
+		double temperature,
+		Batch& res) const;
+
+  const size_t itab_;
+  const size_t jtab_;
+  const double x0_;
+  const double y0_;
+  const double dx_;
+  const double dy_;
+  //! \brief Electrons are an ideal gas below this log(rho*Ye)
+  const double x_gas_;
+  const double x_min_;
+  const double x_max_;
+  const double y_min_;
+  const double y_max_;
+  //! \brief Energy, pressure, Fermi and padding per node, xtab index fastest
+  const vector<double> nodes_;
+};
+
+#endif // ELECTRON_TABLE_HPP
@@ -1,8 +1,8 @@
 #include "energy_appendix.hpp"
 #include "safe_retrieve.hpp"
 
-EnergyAppendix::EnergyAppendix(const FermiTable& eos):
-  eos_(eos) {}
+EnergyAppendix::EnergyAppendix(EosCache& eos_cache):
+  eos_cache_(eos_cache) {}
 
 string EnergyAppendix::getName(void) const
 {
@@ -17,9 +17,10 @@ vector<double> EnergyAppendix::operator()(const hdsim& sim) const
     const ComputationalCell& cell = cells[i];
     if(safe_retrieve(cell.stickers,string("ghost")))
       continue;
-    res[i] = eos_.dp2e(cell.density,
-		       cell.pressure,
-		       cell.tracers);
+    res[i] = eos_cache_.dp2state(i,
+				 cell.density,
+				 cell.pressure,
+				 cell.tracers).energy;
   }
   return res;
 }
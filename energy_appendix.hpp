@@ -2,20 +2,20 @@
 #define ENERGY_APPENDIX_HPP 1
 
 #include "source/newtonian/two_dimensional/hdf5_diagnostics.hpp"
-#include "fermi_table.hpp"
+#include "eos_cache.hpp"
 
 class EnergyAppendix: public DiagnosticAppendix
 {
 public:
 
-  EnergyAppendix(const FermiTable& eos);
+  EnergyAppendix(EosCache& eos_cache);
 
   string getName(void) const;
 
   vector<double> operator()(const hdsim& sim) const;
 
 private:
-  const FermiTable& eos_;
+  EosCache& eos_cache_;
 };
 
 #endif // ENERGY_APPENDIX_HPP
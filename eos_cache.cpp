@@ -0,0 +1,238 @@
+#include <cmath>
+#include "eos_cache.hpp"
+#include "safe_retrieve.hpp"
+
+namespace {
+  typedef double FermiTable::ThermodynamicVariables::* StateField;
+
+  const StateField state_fields[] =
+    {&FermiTable::ThermodynamicVariables::density,
+     &FermiTable::ThermodynamicVariables::energy,
+     &FermiTable::ThermodynamicVariables::pressure,
+     &FermiTable::ThermodynamicVariables::temperature,
+     &FermiTable::ThermodynamicVariables::entropy,
+     &FermiTable::ThermodynamicVariables::sound_speed,
+     &FermiTable::ThermodynamicVariables::chemical_potential,
+     &FermiTable::ThermodynamicVariables::dp_drho,
+     &FermiTable::ThermodynamicVariables::dp_de,
+     &FermiTable::ThermodynamicVariables::de_drho,
+     &FermiTable::ThermodynamicVariables::de_dt};
+
+  const char* const state_names[] =
+    {"density", "energy", "pressure", "temperature", "entropy",
+     "sound_speed", "chemical_potential", "dp_drho", "dp_de",
+     "de_drho", "de_dt"};
+
+  const size_t state_count = sizeof(state_fields)/sizeof(state_fields[0]);
+}
+
+EosCache::Entry::Entry(void):
+  valid(false), aap(0,0), state() {}
+
+EosCache::EosCache(const FermiTable& eos,
+		   double tolerance,
+		   bool strict,
+		   PhaseProfiler& prof):
+  eos_(eos),
+  tolerance_(tolerance),
+  strict_(strict),
+  entries_(),
+  hits_(0),
+  misses_(0),
+  prof_(prof),
+  hit_counter_(prof.addCounter("eos_cache_hits")),
+  miss_counter_(prof.addCounter("eos_cache_misses"))
+{
+  if(!(tolerance>=0))
+    throw "eos_cache_tolerance must not be negative";
+}
+
+bool EosCache::close(double value, double stored) const
+{
+  return std::abs(value-stored)<=tolerance_*std::abs(stored);
+}
+
+EosCache::Entry& EosCache::lookup(size_t index,
+				  const pair<double,double>& aap)
+{
+  if(index>=entries_.size())
+    entries_.resize(index+1);
+  Entry& res = entries_[index];
+  if(strict_ ||
+     !close(aap.first, res.aap.first) ||
+     !close(aap.second, res.aap.second))
+    res.valid = false;
+  return res;
+}
+
+void EosCache::countHit(void)
+{
+#ifdef _OPENMP
+#pragma omp critical(eos_cache_counts)
+#endif
+  {
+    ++hits_;
+    prof_.count(hit_counter_);
+  }
+}
+
+void EosCache::countMiss(void)
+{
+#ifdef _OPENMP
+#pragma omp critical(eos_cache_counts)
+#endif
+  {
+    ++misses_;
+    prof_.count(miss_counter_);
+  }
+}
+
+FermiTable::ThermodynamicVariables EosCache::dp2state
+(size_t index,
+ double density,
+ double pressure,
+ const boost::container::flat_map<string,double>& tracers)
+{
+  const pair<double,double> aap = eos_.calcAverageAtomicProperties(tracers);
+  Entry& entry = lookup(index, aap);
+  if(entry.valid &&
+     close(density, entry.state.density) &&
+     close(pressure, entry.state.pressure)){
+    countHit();
+    return entry.state;
+  }
+  countMiss();
+  // The cell's last temperature is much closer to the solution than a
+  // fixed guess
+  const double temperature = entry.state.temperature;
+  // Stays invalid if the inversion throws, so a partial state is never
+  // served
+  entry.valid = false;
+  entry.state = FermiTable::ThermodynamicVariables();
+  entry.state.density = density;
+  entry.state.pressure = pressure;
+  entry.state.temperature = temperature;
+  eos_.calcThermoVars(FermiTable::rho_prs, aap, entry.state);
+  entry.aap = aap;
+  entry.valid = true;
+  return entry.state;
+}
+
+FermiTable::ThermodynamicVariables EosCache::de2state
+(size_t index,
+ double density,
+ double energy,
+ const boost::container::flat_map<string,double>& tracers)
+{
+  const pair<double,double> aap = eos_.calcAverageAtomicProperties(tracers);
+  Entry& entry = lookup(index, aap);
+  if(entry.valid &&
+     close(density, entry.state.density) &&
+     close(energy, entry.state.energy)){
+    countHit();
+    return entry.state;
+  }
+  countMiss();
+  const double temperature = entry.state.temperature;
+  entry.valid = false;
+  entry.state = FermiTable::ThermodynamicVariables();
+  entry.state.density = density;
+  entry.state.energy = energy;
+  entry.state.temperature = temperature;
+  eos_.calcThermoVars(FermiTable::rho_enr, aap, entry.state);
+  entry.aap = aap;
+  entry.valid = true;
+  return entry.state;
+}
+
+void EosCache::seedTemperatures(const vector<double>& temperatures)
+{
+  if(temperatures.size()>entries_.size())
+    entries_.resize(temperatures.size());
+  for(size_t i=0;i<temperatures.size();++i){
+    if(!entries_[i].valid)
+      entries_[i].state.temperature = temperatures[i];
+  }
+}
+
+void EosCache::reserve(size_t n)
+{
+  if(n>entries_.size())
+    entries_.resize(n);
+}
+
+void EosCache::invalidate(void)
+{
+  for(size_t i=0;i<entries_.size();++i)
+    entries_[i].valid = false;
+}
+
+const FermiTable& EosCache::getEOS(void) const
+{
+  return eos_;
+}
+
+size_t EosCache::getHits(void) const
+{
+  return hits_;
+}
+
+size_t EosCache::getMisses(void) const
+{
+  return misses_;
+}
+
+void EosCache::saveState(map<string,double>& state)
+{
+  state["eos_cache hits"] = static_cast<double>(hits_);
+  state["eos_cache misses"] = static_cast<double>(misses_);
+}
+
+void EosCache::loadState(const map<string,double>& state)
+{
+  hits_ = static_cast<size_t>(safe_retrieve(state,string("eos_cache hits")));
+  misses_ =
+    static_cast<size_t>(safe_retrieve(state,string("eos_cache misses")));
+}
+
+void EosCache::saveArrays(map<string,vector<double> >& arrays)
+{
+  vector<double>& valid = arrays["eos_cache valid"];
+  vector<double>& aap_a = arrays["eos_cache aap_a"];
+  vector<double>& aap_z = arrays["eos_cache aap_z"];
+  valid.resize(entries_.size());
+  aap_a.resize(entries_.size());
+  aap_z.resize(entries_.size());
+  for(size_t i=0;i<entries_.size();++i){
+    valid[i] = entries_[i].valid ? 1 : 0;
+    aap_a[i] = entries_[i].aap.first;
+    aap_z[i] = entries_[i].aap.second;
+  }
+  for(size_t k=0;k<state_count;++k){
+    vector<double>& values = arrays[string("eos_cache ")+state_names[k]];
+    values.resize(entries_.size());
+    for(size_t i=0;i<entries_.size();++i)
+      values[i] = entries_[i].state.*state_fields[k];
+  }
+}
+
+void EosCache::loadArrays(const map<string,vector<double> >& arrays)
+{
+  const vector<double>& valid =
+    safe_retrieve(arrays,string("eos_cache valid"));
+  const vector<double>& aap_a =
+    safe_retrieve(arrays,string("eos_cache aap_a"));
+  const vector<double>& aap_z =
+    safe_retrieve(arrays,string("eos_cache aap_z"));
+  entries_.assign(valid.size(), Entry());
+  for(size_t i=0;i<entries_.size();++i){
+    entries_[i].valid = valid.at(i)>0.5;
+    entries_[i].aap = pair<double,double>(aap_a.at(i), aap_z.at(i));
+  }
+  for(size_t k=0;k<state_count;++k){
+    const vector<double>& values =
+      safe_retrieve(arrays,string("eos_cache ")+state_names[k]);
+    for(size_t i=0;i<entries_.size();++i)
+      entries_[i].state.*state_fields[k] = values.at(i);
+  }
+}
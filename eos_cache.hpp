@@ -0,0 +1,122 @@
+#ifndef EOS_CACHE_HPP
+#define EOS_CACHE_HPP 1
+
+#include "fermi_table.hpp"
+#include "phase_profiler.hpp"
+#include "checkpoint_state.hpp"
+
+/*! \brief Last equation of state result of each cell
+  \details Every inversion stores the full state of the cell, which answers
+  both density-pressure and density-energy queries. A query is served from
+  the cache if density, the queried variable and the average atomic
+  properties are all within a relative tolerance of the stored state. Since
+  the stored state is only replaced on a miss, the error does not accumulate
+  over steps. Each inversion starts from the cell's last temperature, which
+  is kept here rather than with the cell. The cells are identified by
+  index, so a renumbered mesh only costs misses. The stored states go into
+  checkpoints, so a restarted run reuses the same results as an
+  uninterrupted one. Queries for different cells may run in parallel once
+  reserve has sized the cache.
+ */
+class EosCache: public CheckpointState
+{
+public:
+
+  /*! \brief Class constructor
+    \param eos Equation of state
+    \param tolerance Relative tolerance below which results are reused. Zero reuses exact matches only
+    \param strict Never reuse results, for verification runs
+    \param prof Profiler, for the hit and miss counts
+   */
+  EosCache(const FermiTable& eos,
+	   double tolerance,
+	   bool strict,
+	   PhaseProfiler& prof);
+
+  /*! \brief Full thermodynamic state from density and pressure
+    \param index Cell index
+    \param density Density
+    \param pressure Pressure
+    \param tracers Tracers of the cell
+    \return Thermodynamic state
+   */
+  FermiTable::ThermodynamicVariables dp2state
+  (size_t index,
+   double density,
+   double pressure,
+   const boost::container::flat_map<string,double>& tracers);
+
+  /*! \brief Full thermodynamic state from density and energy
+    \param index Cell index
+    \param density Density
+    \param energy Specific thermal energy
+    \param tracers Tracers of the cell
+    \return Thermodynamic state
+   */
+  FermiTable::ThermodynamicVariables de2state
+  (size_t index,
+   double density,
+   double energy,
+   const boost::container::flat_map<string,double>& tracers);
+
+  /*! \brief Sets the starting temperatures of cells without a stored state
+    \param temperatures Temperature of each cell, such as the initial profile
+   */
+  void seedTemperatures(const vector<double>& temperatures);
+
+  /*! \brief Makes room for a number of cells, so parallel queries never resize the cache
+    \param n Number of cells
+   */
+  void reserve(size_t n);
+
+  //! \brief Discards every stored state, keeping the starting temperatures
+  void invalidate(void);
+
+  const FermiTable& getEOS(void) const;
+
+  size_t getHits(void) const;
+
+  size_t getMisses(void) const;
+
+  void saveState(map<string,double>& state);
+
+  void loadState(const map<string,double>& state);
+
+  void saveArrays(map<string,vector<double> >& arrays);
+
+  void loadArrays(const map<string,vector<double> >& arrays);
+
+private:
+
+  //! \brief Stored state of one cell
+  class Entry
+  {
+  public:
+
+    Entry(void);
+
+    bool valid;
+    pair<double,double> aap;
+    FermiTable::ThermodynamicVariables state;
+  };
+
+  bool close(double value, double stored) const;
+
+  Entry& lookup(size_t index, const pair<double,double>& aap);
+
+  void countHit(void);
+
+  void countMiss(void);
+
+  const FermiTable& eos_;
+  const double tolerance_;
+  const bool strict_;
+  vector<Entry> entries_;
+  size_t hits_;
+  size_t misses_;
+  PhaseProfiler& prof_;
+  const size_t hit_counter_;
+  const size_t miss_counter_;
+};
+
+#endif // EOS_CACHE_HPP
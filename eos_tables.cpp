@@ -0,0 +1,337 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdint.h>
+#include "eos_tables.hpp"
+#include "fnv_hash.hpp"
+#include "wall_clock.hpp"
+
+extern "C" {
+  void set_tables(int itab,
+		  int jtab,
+		  double dxtab,
+		  double dytab,
+		  const double* xtab,
+		  const double* ytab,
+		  const double* etab,
+		  const double* ptab,
+		  const double* efer);
+}
+
+namespace {
+  bool eos_tables_loaded = false;
+
+  // Layout of the coded table records, Fortran format (2x,8es15.7)
+  const size_t record_prefix = 2;
+  const size_t field_width = 15;
+  const size_t fields_per_record = 8;
+
+  // Powers of ten that are exact in double precision
+  const double exact_powers_of_ten[] =
+    {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+     1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+  string read_file(const string& fname)
+  {
+    std::ifstream f(fname.c_str(), std::ios::binary);
+    if(!f)
+      throw "failed to open " + fname;
+    f.seekg(0, std::ios::end);
+    const std::streamoff size = f.tellg();
+    f.seekg(0, std::ios::beg);
+    string res(static_cast<size_t>(size), '\0');
+    if(size>0 && !f.read(&res[0], size))
+      throw "failed to read " + fname;
+    return res;
+  }
+
+  /* Parses one fixed width field. Fields with at most 15 significant digits
+     and a decimal exponent of at most 22 are converted with a single exact
+     multiplication or division, so the result is correctly rounded, the
+     same as strtod. Anything else falls back on strtod. Returns false if
+     the field is not a number. */
+  bool parse_field(const char* begin, const char* end, double& res)
+  {
+    const char* p = begin;
+    while(p<end && *p==' ')
+      ++p;
+    const char* const number = p;
+    bool negative = false;
+    if(p<end && (*p=='-' || *p=='+')){
+      negative = *p=='-';
+      ++p;
+    }
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int decimals = 0;
+    bool point = false;
+    bool any_digit = false;
+    for(;p<end;++p){
+      if(*p>='0' && *p<='9'){
+	any_digit = true;
+	if(mantissa==0 && *p=='0'){
+	  if(point)
+	    ++decimals;
+	  continue;
+	}
+	if(digits<19)
+	  mantissa = 10*mantissa + static_cast<uint64_t>(*p-'0');
+	++digits;
+	if(point)
+	  ++decimals;
+      }
+      else if(*p=='.' && !point)
+	point = true;
+      else
+	break;
+    }
+    int exponent = 0;
+    bool fast = any_digit && digits<=15;
+    if(p<end && (*p=='E' || *p=='e' || *p=='D' || *p=='d')){
+      ++p;
+      bool negative_exponent = false;
+      if(p<end && (*p=='-' || *p=='+')){
+	negative_exponent = *p=='-';
+	++p;
+      }
+      const char* const exponent_begin = p;
+      for(;p<end && *p>='0' && *p<='9';++p)
+	if(exponent<10000)
+	  exponent = 10*exponent + (*p-'0');
+      if(p==exponent_begin)
+	fast = false;
+      if(negative_exponent)
+	exponent = -exponent;
+    }
+    while(p<end && *p==' ')
+      ++p;
+    const int power = exponent - decimals;
+    if(fast && p==end && power>=-22 && power<=22){
+      double value = static_cast<double>(mantissa);
+      if(power>=0)
+	value *= exact_powers_of_ten[power];
+      else
+	value /= exact_powers_of_ten[-power];
+      res = negative ? -value : value;
+      return true;
+    }
+    const string buffer(number, end);
+    if(buffer.empty())
+      return false;
+    char* stop = 0;
+    res = strtod(buffer.c_str(), &stop);
+    while(*stop==' ')
+      ++stop;
+    return stop!=buffer.c_str() && *stop=='\0';
+  }
+
+  //! \brief Sequential reader for the coded table format
+  class TableReader
+  {
+  public:
+
+    TableReader(const string& fname, const string& text):
+      fname_(fname), text_(text), pos_(0), line_(0) {}
+
+    string nextLine(void)
+    {
+      if(pos_>=text_.size())
+	throw error("unexpected end of file");
+      const size_t end = text_.find('\n', pos_);
+      const size_t stop = end==string::npos ? text_.size() : end;
+      string res = text_.substr(pos_, stop-pos_);
+      if(!res.empty() && res[res.size()-1]=='\r')
+	res.erase(res.size()-1);
+      pos_ = end==string::npos ? text_.size() : end+1;
+      ++line_;
+      return res;
+    }
+
+    /*! \brief Reads values the way a Fortran read with format
+      (2x,8es15.7) does, starting on a fresh record
+      \param n Number of values
+      \param name Array name for error messages
+      \return Values
+     */
+    vector<double> readRecords(size_t n, const string& name)
+    {
+      // Every value takes at least one field, so a truncated file is
+      // caught before the allocation
+      if((text_.size()-pos_)/field_width<n)
+	throw error(name+" extends past the end of the file");
+      vector<double> res(n);
+      for(size_t i=0;i<n;i+=fields_per_record){
+	const string line = nextLine();
+	const size_t count = std::min(fields_per_record, n-i);
+	if(line.size()<record_prefix+count*field_width)
+	  throw error("truncated record in "+name);
+	for(size_t j=0;j<count;++j){
+	  const char* const field =
+	    line.c_str() + record_prefix + j*field_width;
+	  if(!parse_field(field, field+field_width, res[i+j]))
+	    throw error("malformed entry '"+string(field,field_width)+
+			"' in "+name);
+	  if(!std::isfinite(res[i+j]))
+	    throw error("non finite entry in "+name);
+	}
+      }
+      return res;
+    }
+
+    //! \brief Error message pointing at the current line
+    string error(const string& message) const
+    {
+      std::ostringstream ss;
+      ss << fname_ << ":" << line_ << ": " << message;
+      return ss.str();
+    }
+
+  private:
+    const string& fname_;
+    const string& text_;
+    size_t pos_;
+    size_t line_;
+  };
+
+  void check_axis(const vector<double>& axis,
+		  double spacing,
+		  const string& name,
+		  const string& fname)
+  {
+    for(size_t i=1;i<axis.size();++i){
+      const double step = axis[i] - axis[i-1];
+      if(!(step>0) || std::abs(step-spacing)>1e-4*spacing){
+	std::ostringstream ss;
+	ss.precision(8);
+	ss << fname << ": " << name << " is not uniformly increasing with step "
+	   << spacing << " at entry " << i+1 << " (step " << step << ")";
+	throw ss.str();
+      }
+    }
+  }
+}
+
+EosTables::EosTables(const string& fname):
+  fname_(fname),
+  hash_(),
+  xtab_(),
+  ytab_(),
+  etab_(),
+  ptab_(),
+  efer_(),
+  dxtab_(0),
+  dytab_(0),
+  read_time_(0),
+  parse_time_(0),
+  load_time_(0)
+{
+  assert(!eos_tables_loaded);
+  const double begin = wall_clock();
+  const string text = read_file(fname);
+  read_time_ = wall_clock() - begin;
+  FnvHash hash;
+  hash.add(text.data(), text.size());
+  hash_ = hash.hex();
+
+  const double parse_begin = wall_clock();
+  TableReader reader(fname, text);
+  reader.nextLine();
+  int itab = 0;
+  int jtab = 0;
+  if(sscanf(reader.nextLine().c_str(), "%d %d %lf %lf",
+	    &itab, &jtab, &dxtab_, &dytab_)!=4)
+    throw reader.error("expected itab,jtab,dxtab,dytab");
+  // The interpolation stencil spans four nodes in each direction
+  if(itab<4 || jtab<4)
+    throw reader.error("table must have at least 4 nodes in each direction");
+  if(!(dxtab_>0) || !(dytab_>0) ||
+     !std::isfinite(dxtab_) || !std::isfinite(dytab_))
+    throw reader.error("table spacing must be positive");
+  const size_t rows = static_cast<size_t>(itab);
+  const size_t columns = static_cast<size_t>(jtab);
+  xtab_ = reader.readRecords(rows, "xtab");
+  ytab_ = reader.readRecords(columns, "ytab");
+  etab_ = reader.readRecords(rows*columns, "etab");
+  ptab_ = reader.readRecords(rows*columns, "ptab");
+  efer_ = reader.readRecords(rows*columns, "efer");
+  // The kernels locate nodes from xtab(1) and the spacing alone
+  check_axis(xtab_, dxtab_, "xtab", fname);
+  check_axis(ytab_, dytab_, "ytab", fname);
+  parse_time_ = wall_clock() - parse_begin;
+
+  set_tables(itab,
+	     jtab,
+	     dxtab_,
+	     dytab_,
+	     &xtab_[0],
+	     &ytab_[0],
+	     &etab_[0],
+	     &ptab_[0],
+	     &efer_[0]);
+  load_time_ = wall_clock() - begin;
+  eos_tables_loaded = true;
+}
+
+const string& EosTables::getFileName(void) const
+{
+  return fname_;
+}
+
+const string& EosTables::getFileHash(void) const
+{
+  return hash_;
+}
+
+double EosTables::getLoadTime(void) const
+{
+  return load_time_;
+}
+
+double EosTables::getReadTime(void) const
+{
+  return read_time_;
+}
+
+double EosTables::getParseTime(void) const
+{
+  return parse_time_;
+}
+
+const vector<double>& EosTables::getXTab(void) const
+{
+  return xtab_;
+}
+
+const vector<double>& EosTables::getYTab(void) const
+{
+  return ytab_;
+}
+
+const vector<double>& EosTables::getETab(void) const
+{
+  return etab_;
+}
+
+const vector<double>& EosTables::getPTab(void) const
+{
+  return ptab_;
+}
+
+const vector<double>& EosTables::getEFer(void) const
+{
+  return efer_;
+}
+
+double EosTables::getDXTab(void) const
+{
+  return dxtab_;
+}
+
+double EosTables::getDYTab(void) const
+{
+  return dytab_;
+}
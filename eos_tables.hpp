@@ -0,0 +1,77 @@
+#ifndef EOS_TABLES_HPP
+#define EOS_TABLES_HPP 1
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+/*! \brief Tabulated equation of state
+  \details The table file is parsed and validated here, and the arrays are
+  handed to the Fortran tables module, which points at them rather than
+  keeping its own copy. The module state is global, so there can only be one
+  instance per process, and it has to outlive every equation of state call.
+  Runs that share a process, or are forked from it, share the loaded tables.
+ */
+class EosTables
+{
+public:
+
+  /*! \brief Loads the tables
+    \param fname Name of table file
+   */
+  explicit EosTables(const string& fname);
+
+  const string& getFileName(void) const;
+
+  //! \brief Hash of the table file contents
+  const string& getFileHash(void) const;
+
+  //! \brief Wall clock seconds spent loading
+  double getLoadTime(void) const;
+
+  //! \brief Wall clock seconds spent reading the file
+  double getReadTime(void) const;
+
+  //! \brief Wall clock seconds spent parsing and validating
+  double getParseTime(void) const;
+
+  //! \brief Logarithm of electron density nodes (rho*Ye)
+  const vector<double>& getXTab(void) const;
+
+  //! \brief Logarithm of temperature nodes
+  const vector<double>& getYTab(void) const;
+
+  //! \brief Logarithm of electron energy density, xtab index fastest
+  const vector<double>& getETab(void) const;
+
+  //! \brief Ratio of electron pressure to energy density
+  const vector<double>& getPTab(void) const;
+
+  //! \brief Electron chemical potential term, returned as xfermi
+  const vector<double>& getEFer(void) const;
+
+  double getDXTab(void) const;
+
+  double getDYTab(void) const;
+
+private:
+  const string fname_;
+  string hash_;
+  vector<double> xtab_;
+  vector<double> ytab_;
+  vector<double> etab_;
+  vector<double> ptab_;
+  vector<double> efer_;
+  double dxtab_;
+  double dytab_;
+  double read_time_;
+  double parse_time_;
+  double load_time_;
+
+  EosTables(const EosTables&);
+  EosTables& operator=(const EosTables&);
+};
+
+#endif // EOS_TABLES_HPP
@@ -1,9 +1,9 @@
 #include <iostream>
+#include <stdint.h>
 #include "fermi_table.hpp"
+#include "fnv_hash.hpp"
 
 extern "C" {
-  void init_tabular_(const char* eos_tab_file);
-
   void eos_fermi_(int* keyeos,
 		  int* im_gas,
 		  int* im_photons,
@@ -22,9 +22,36 @@ extern "C" {
 		  double* dedt,
 		  double* sounds,
 		  int* keyerror);
+
+  extern int64_t eos_rho_tmp_calls;
 }
 
-FermiTable::FermiTable(const string& tab_file,
+namespace {
+  string calc_table_hash
+  (const EosTables& tables,
+   int im_gas,
+   int im_photons,
+   int im_coulomb,
+   const map<string,pair<double,double> >& atomic_properties)
+  {
+    FnvHash hash;
+    hash.add(tables.getFileHash());
+    hash.add(&im_gas, sizeof(im_gas));
+    hash.add(&im_photons, sizeof(im_photons));
+    hash.add(&im_coulomb, sizeof(im_coulomb));
+    for(map<string,pair<double,double> >::const_iterator it=
+	  atomic_properties.begin();
+	it!=atomic_properties.end();
+	++it){
+      hash.add(it->first);
+      hash.add(it->second.first);
+      hash.add(it->second.second);
+    }
+    return hash.hex();
+  }
+}
+
+FermiTable::FermiTable(const EosTables& tables,
 		       const int im_gas,
 		       const int im_photons,
 		       const int im_coulomb,
@@ -32,11 +59,15 @@ FermiTable::FermiTable(const string& tab_file,
   im_gas_(im_gas),
   im_photons_(im_photons),
   im_coulomb_(im_coulomb),
-  atomic_properties_(atomic_properties)
-{
-  assert(tab_file.size()<80);
-  init_tabular_(tab_file.c_str());
-}
+  atomic_properties_(atomic_properties),
+  call_count_(0),
+  inversion_count_(0),
+  inversion_iterations_(0),
+  table_hash_(calc_table_hash(tables,
+			      im_gas,
+			      im_photons,
+			      im_coulomb,
+			      atomic_properties)) {}
 
 double FermiTable::dt2paz(double density, double temperature,
 			  std::pair<double,double> aap) const
@@ -105,7 +136,12 @@ double FermiTable::de2c
  double energy, 
  const boost::container::flat_map<string,double>& tracers) const
 {
-  return deaz2c(density, energy, calcAverageAtomicProperties(tracers));
+  return calcSingleThermoVar(std::pair<double,double ThermodynamicVariables::*>
+			     (density,&ThermodynamicVariables::density),
+			     std::pair<double,double ThermodynamicVariables::*>
+			     (energy,&ThermodynamicVariables::energy),
+			     calcAverageAtomicProperties(tracers),
+			     &ThermodynamicVariables::sound_speed);
 }
 
 double FermiTable::de2p
@@ -113,7 +149,12 @@ double FermiTable::de2p
  double energy,
  const boost::container::flat_map<string,double>& tracers) const
 {
-  return deaz2p(density, energy, calcAverageAtomicProperties(tracers));
+  return calcSingleThermoVar(std::pair<double,double ThermodynamicVariables::*>
+			     (density,&ThermodynamicVariables::density),
+			     std::pair<double,double ThermodynamicVariables::*>
+			     (energy,&ThermodynamicVariables::energy),
+			     calcAverageAtomicProperties(tracers),
+			     &ThermodynamicVariables::pressure);
 }
 
 double FermiTable::dpaz2c(double density, double pressure,
@@ -132,7 +173,12 @@ double FermiTable::dp2c
  double pressure,
  const boost::container::flat_map<string,double>& tracers) const
 {
-  return dpaz2c(density,pressure,calcAverageAtomicProperties(tracers));
+  return calcSingleThermoVar(std::pair<double,double ThermodynamicVariables::*>
+			     (density,&ThermodynamicVariables::density),
+			     std::pair<double,double ThermodynamicVariables::*>
+			     (pressure,&ThermodynamicVariables::pressure),
+			     calcAverageAtomicProperties(tracers),
+			     &ThermodynamicVariables::sound_speed);
 }
 
 double FermiTable::dp2e
@@ -140,7 +186,12 @@ double FermiTable::dp2e
  double pressure,
  const boost::container::flat_map<string,double>& tracers) const
 {
-  return dpaz2e(density,pressure,calcAverageAtomicProperties(tracers));
+  return calcSingleThermoVar(std::pair<double,double ThermodynamicVariables::*>
+			     (density,&ThermodynamicVariables::density),
+			     std::pair<double,double ThermodynamicVariables::*>
+			     (pressure,&ThermodynamicVariables::pressure),
+			     calcAverageAtomicProperties(tracers),
+			     &ThermodynamicVariables::energy);
 }
 
 double FermiTable::dp2t
@@ -148,7 +199,12 @@ double FermiTable::dp2t
  double pressure,
  const boost::container::flat_map<string,double>& tracers) const
 {
-  return dpaz2t(density,pressure,calcAverageAtomicProperties(tracers));
+  return calcSingleThermoVar(std::pair<double,double ThermodynamicVariables::*>
+			     (density,&ThermodynamicVariables::density),
+			     std::pair<double,double ThermodynamicVariables::*>
+			     (pressure,&ThermodynamicVariables::pressure),
+			     calcAverageAtomicProperties(tracers),
+			     &ThermodynamicVariables::temperature);
 }
 
 double FermiTable::dt2e(double density, double temperature,
@@ -201,7 +257,44 @@ namespace {
 }
 
 FermiTable::ThermodynamicVariables::ThermodynamicVariables(void):
-  density(1e7), energy(1e7), pressure(1e7), temperature(1e7), entropy(1e7), sound_speed(1e7) {}
+  density(1e7), energy(1e7), pressure(1e7), temperature(1e7), entropy(1e7), sound_speed(1e7),
+  chemical_potential(0), dp_drho(0), dp_de(0), de_drho(0), de_dt(0) {}
+
+FermiTable::ThermodynamicVariables FermiTable::dp2state
+(double density,
+ double pressure,
+ const boost::container::flat_map<string,double>& tracers) const
+{
+  ThermodynamicVariables res;
+  res.density = density;
+  res.pressure = pressure;
+  calcThermoVars(rho_prs, calcAverageAtomicProperties(tracers), res);
+  return res;
+}
+
+FermiTable::ThermodynamicVariables FermiTable::de2state
+(double density,
+ double energy,
+ const boost::container::flat_map<string,double>& tracers) const
+{
+  ThermodynamicVariables res;
+  res.density = density;
+  res.energy = energy;
+  calcThermoVars(rho_enr, calcAverageAtomicProperties(tracers), res);
+  return res;
+}
+
+FermiTable::ThermodynamicVariables FermiTable::dt2state
+(double density,
+ double temperature,
+ const boost::container::flat_map<string,double>& tracers) const
+{
+  ThermodynamicVariables res;
+  res.density = density;
+  res.temperature = temperature;
+  calcThermoVars(rho_tmp, calcAverageAtomicProperties(tracers), res);
+  return res;
+}
 
 double FermiTable::calcSingleThermoVar(std::pair<double,double ThermodynamicVariables::*> input_1,
 				       std::pair<double,double ThermodynamicVariables::*> input_2,
@@ -221,12 +314,12 @@ void FermiTable::calcThermoVars(Mode mode,
 				ThermodynamicVariables& tv) const
 {
   int keyte = mode;
-  double chemical_potential = 0;
-  double dpdro = 0;
-  double dpde = 0;
-  double dedro = 0;
-  double dedt = 0;
   int keyerr = 0;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+  ++call_count_;
+  const int64_t evaluations = eos_rho_tmp_calls;
   eos_fermi_(&keyte,
 	     &im_gas_,
 	     &im_photons_,
@@ -238,13 +331,25 @@ void FermiTable::calcThermoVars(Mode mode,
 	     &tv.entropy,
 	     &aap.first,
 	     &aap.second,
-	     &chemical_potential,
-	     &dpdro,
-	     &dpde,
-	     &dedro,
-	     &dedt,
+	     &tv.chemical_potential,
+	     &tv.dp_drho,
+	     &tv.dp_de,
+	     &tv.de_drho,
+	     &tv.de_dt,
 	     &tv.sound_speed,
 	     &keyerr);
+  if(mode!=rho_tmp){
+    const size_t iterations =
+      static_cast<size_t>(eos_rho_tmp_calls-evaluations);
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+    ++inversion_count_;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+    inversion_iterations_ += iterations;
+  }
 }
 
 std::pair<double,double> FermiTable::calcAverageAtomicProperties
@@ -287,3 +392,23 @@ const map<string,pair<double,double> >& FermiTable::getAtomicProperties(void) co
 {
   return atomic_properties_;
 }
+
+size_t FermiTable::getCallCount(void) const
+{
+  return call_count_;
+}
+
+size_t FermiTable::getInversionCount(void) const
+{
+  return inversion_count_;
+}
+
+size_t FermiTable::getInversionIterations(void) const
+{
+  return inversion_iterations_;
+}
+
+const string& FermiTable::getTableHash(void) const
+{
+  return table_hash_;
+}
@@ -7,6 +7,7 @@
 #define FERMI_TABLE_HPP 1
 
 #include "source/newtonian/common/equation_of_state.hpp"
+#include "eos_tables.hpp"
 
 #include <string>
 #include <cassert>
@@ -22,12 +23,12 @@ class FermiTable: public EquationOfState
 public:
 
   /*! \brief Class constructor
-    \param tab_file Name of table file
+    \param tables Loaded tables
     \param im_gas Gas contribution
     \param im_photons Radiation contribution
     \param im_coulomb Electrostatic contribution
    */
-  FermiTable(const string& tab_file,
+  FermiTable(const EosTables& tables,
 	     const int im_gas,
 	     const int im_photons,
 	     const int im_coulomb,
@@ -150,9 +151,62 @@ public:
     double entropy;
     double sound_speed;
 
+    //! \brief Electron chemical potential term
+    double chemical_potential;
+
+    /*! \brief Pressure derivative with respect to density, at constant
+      temperature (at constant energy in rho_enr mode)
+     */
+    double dp_drho;
+
+    //! \brief Pressure derivative with respect to energy, at constant density
+    double dp_de;
+
+    //! \brief Energy derivative with respect to density, at constant temperature
+    double de_drho;
+
+    //! \brief Energy derivative with respect to temperature, at constant density
+    double de_dt;
+
     ThermodynamicVariables(void);
   };
 
+  /*! \brief Full thermodynamic state from density and pressure
+    \details A single inversion yields temperature, energy, entropy, sound
+    speed and derivatives together, so call sites that need more than one
+    of them should use this instead of the single valued functions
+    \param density Density
+    \param pressure Pressure
+    \param tracers Tracers, for the composition
+    \return Thermodynamic state
+   */
+  ThermodynamicVariables dp2state
+  (double density,
+   double pressure,
+   const boost::container::flat_map<string,double>& tracers) const;
+
+  /*! \brief Full thermodynamic state from density and energy
+    \param density Density
+    \param energy Specific thermal energy
+    \param tracers Tracers, for the composition
+    \return Thermodynamic state
+   */
+  ThermodynamicVariables de2state
+  (double density,
+   double energy,
+   const boost::container::flat_map<string,double>& tracers) const;
+
+  /*! \brief Full thermodynamic state from density and temperature
+    \param density Density
+    \param temperature Temperature
+    \param tracers Tracers, for the composition
+    \return Thermodynamic state
+   */
+  ThermodynamicVariables dt2state
+  (double density,
+   double temperature,
+   const boost::container::flat_map<string,double>& tracers) const;
+
   double calcSingleThermoVar(std::pair<double,double ThermodynamicVariables::*> input_1,
 			     std::pair<double,double ThermodynamicVariables::*> input_2,
 			     std::pair<double,double> aap,
@@ -168,11 +222,30 @@ public:
 
   const map<string,pair<double,double> >& getAtomicProperties(void) const;
 
+  //! \brief Number of calls to the tabulated equation of state so far
+  size_t getCallCount(void) const;
+
+  //! \brief Number of calls that iterate on the temperature
+  size_t getInversionCount(void) const;
+
+  /*! \brief Table evaluations made by those calls
+    \details Approximate when inversions run on several threads, since the
+    evaluation counter in the Fortran module is shared
+   */
+  size_t getInversionIterations(void) const;
+
+  //! \brief Hash of the table file, contributions and atomic properties
+  const string& getTableHash(void) const;
+
 private:
   mutable int im_gas_;
   mutable int im_photons_;
   mutable int im_coulomb_;
   const std::map<string,std::pair<double,double> > atomic_properties_;
+  mutable size_t call_count_;
+  mutable size_t inversion_count_;
+  mutable size_t inversion_iterations_;
+  const string table_hash_;
 };
 
 #endif // FERMI_TABLE_HPP
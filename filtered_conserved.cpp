@@ -1,11 +1,12 @@
-#include <fstream>
 #include "filtered_conserved.hpp"
 #include "safe_retrieve.hpp"
+#include "angular_decomposition.hpp"
+#include "source/misc/vector_initialiser.hpp"
 
 using namespace std;
 
-FilteredConserved::FilteredConserved(const string& fname):
-  data_(), fname_(fname) {}
+FilteredConserved::FilteredConserved(const string& fname, bool binary):
+  sink_(fname, binary) {}
 
 void FilteredConserved::operator()(const hdsim& sim)
 {
@@ -16,23 +17,25 @@ void FilteredConserved::operator()(const hdsim& sim)
   buf.momentum = Vector2D(0,0);
   buf.energy = 0;
   for(size_t i=0;i<extensives.size();++i){
-    if(safe_retrieve(cells[i].stickers,string("ghost")))
+    if(safe_retrieve(cells[i].stickers,string("ghost")) ||
+       is_halo(cells[i]))
       continue;
     buf += extensives[i];
   }
-  data_.push_back
-    (pair<double,Extensive>
-     (sim.getTime(),buf));
+  sink_.writeRow(VectorInitialiser<double>
+		 (sim.getTime())
+		 (buf.mass)
+		 (buf.momentum.x)
+		 (buf.momentum.y)
+		 (buf.energy)());
 }
 
-FilteredConserved::~FilteredConserved(void)
+void FilteredConserved::saveState(map<string,double>& state)
 {
-  ofstream f(fname_.c_str());
-  for(size_t i=0;i<data_.size();++i)
-    f << data_[i].first << " "
-      << data_[i].second.mass << " "
-      << data_[i].second.momentum.x << " "
-      << data_[i].second.momentum.y << " "
-      << data_[i].second.energy << endl;
-  f.close();
+  sink_.saveState(state);
+}
+
+void FilteredConserved::loadState(const map<string,double>& state)
+{
+  sink_.loadState(state);
 }
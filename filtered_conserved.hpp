@@ -3,22 +3,24 @@
 
 #include <string>
 #include "source/newtonian/test_2d/main_loop_2d.hpp"
+#include "diagnostics_sink.hpp"
 
 using std::string;
 
-class FilteredConserved: public DiagnosticFunction
+class FilteredConserved: public DiagnosticFunction, public CheckpointState
 {
 public:
 
-  FilteredConserved(const string& fname);
+  explicit FilteredConserved(const string& fname, bool binary=false);
 
   void operator()(const hdsim& sim);
 
-  ~FilteredConserved(void);
+  void saveState(map<string,double>& state);
+
+  void loadState(const map<string,double>& state);
 
 private:
-  mutable vector<pair<double,Extensive> > data_;
-  const string fname_;
+  DiagnosticsSink sink_;
 };
 
 #endif // FILTERED_CONSERVED_HPP
@@ -0,0 +1,48 @@
+#include <sstream>
+#include <iomanip>
+#include <fstream>
+#include "fnv_hash.hpp"
+
+FnvHash::FnvHash(void):
+  value_(static_cast<uint64_t>(14695981039346656037UL)) {}
+
+void FnvHash::add(const void* data, size_t size)
+{
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  for(size_t i=0;i<size;++i){
+    value_ ^= bytes[i];
+    value_ *= static_cast<uint64_t>(1099511628211UL);
+  }
+}
+
+void FnvHash::add(const string& s)
+{
+  add(vector<char>(s.begin(),s.end()));
+}
+
+void FnvHash::add(double x)
+{
+  add(&x, sizeof(x));
+}
+
+void FnvHash::addFile(const string& fname)
+{
+  std::ifstream f(fname.c_str(), std::ios::binary);
+  if(!f)
+    throw "failed to open " + fname;
+  char buf[1<<16];
+  while(f.read(buf, sizeof(buf)) || f.gcount()>0)
+    add(buf, static_cast<size_t>(f.gcount()));
+}
+
+uint64_t FnvHash::value(void) const
+{
+  return value_;
+}
+
+string FnvHash::hex(void) const
+{
+  std::ostringstream ss;
+  ss << std::hex << std::setw(16) << std::setfill('0') << value_;
+  return ss.str();
+}
@@ -0,0 +1,52 @@
+#ifndef FNV_HASH_HPP
+#define FNV_HASH_HPP 1
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <stdint.h>
+
+using std::vector;
+using std::string;
+using std::size_t;
+
+//! \brief Incremental 64 bit FNV-1a hash
+class FnvHash
+{
+public:
+
+  FnvHash(void);
+
+  /*! \brief Adds raw bytes to the hash
+    \param data Pointer to data
+    \param size Number of bytes
+   */
+  void add(const void* data, size_t size);
+
+  void add(const string& s);
+
+  void add(double x);
+
+  /*! \brief Adds the contents of a file
+    \param fname File name
+   */
+  void addFile(const string& fname);
+
+  template<class T> void add(const vector<T>& v)
+  {
+    const size_t size = v.size();
+    add(&size, sizeof(size));
+    if(!v.empty())
+      add(&v[0], v.size()*sizeof(T));
+  }
+
+  uint64_t value(void) const;
+
+  //! \brief Hash value as 16 hexadecimal digits
+  string hex(void) const;
+
+private:
+  uint64_t value_;
+};
+
+#endif // FNV_HASH_HPP
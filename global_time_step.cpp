@@ -0,0 +1,15 @@
+#include "global_time_step.hpp"
+#include "mpi_support.hpp"
+
+GlobalTimeStep::GlobalTimeStep(const TimeStepFunction& local):
+  local_(local) {}
+
+double GlobalTimeStep::operator()
+  (const Tessellation& tess,
+   const vector<ComputationalCell>& cells,
+   const EquationOfState& eos,
+   const vector<Vector2D>& point_velocities,
+   const double time) const
+{
+  return global_min(local_(tess, cells, eos, point_velocities, time));
+}
@@ -0,0 +1,27 @@
+#ifndef GLOBAL_TIME_STEP_HPP
+#define GLOBAL_TIME_STEP_HPP 1
+
+#include "source/newtonian/two_dimensional/time_step_function.hpp"
+
+//! \brief Smallest time step of all ranks, so they advance together
+class GlobalTimeStep: public TimeStepFunction
+{
+public:
+
+  /*! \brief Class constructor
+    \param local Time step of the cells of this rank
+   */
+  explicit GlobalTimeStep(const TimeStepFunction& local);
+
+  double operator()
+  (const Tessellation& tess,
+   const vector<ComputationalCell>& cells,
+   const EquationOfState& eos,
+   const vector<Vector2D>& point_velocities,
+   const double time) const;
+
+private:
+  const TimeStepFunction& local_;
+};
+
+#endif // GLOBAL_TIME_STEP_HPP
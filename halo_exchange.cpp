@@ -0,0 +1,116 @@
+#include "halo_exchange.hpp"
+#include "cell_extensive.hpp"
+#ifdef WITH_MPI
+#include <mpi.h>
+#endif
+
+namespace {
+  size_t values_per_cell(const ComputationalCell& cell)
+  {
+    return 4+cell.tracers.size();
+  }
+
+  void pack(const vector<ComputationalCell>& cells,
+	    const vector<size_t>& indices,
+	    vector<double>& buffer)
+  {
+    buffer.clear();
+    for(size_t i=0;i<indices.size();++i){
+      const ComputationalCell& cell = cells[indices[i]];
+      buffer.push_back(cell.density);
+      buffer.push_back(cell.pressure);
+      buffer.push_back(cell.velocity.x);
+      buffer.push_back(cell.velocity.y);
+      for(boost::container::flat_map<string,double>::const_iterator it =
+	    cell.tracers.begin();
+	  it!=cell.tracers.end();
+	  ++it)
+	buffer.push_back(it->second);
+    }
+  }
+
+  void unpack(const vector<double>& buffer,
+	      const vector<size_t>& indices,
+	      vector<ComputationalCell>& cells)
+  {
+    size_t k = 0;
+    for(size_t i=0;i<indices.size();++i){
+      ComputationalCell& cell = cells[indices[i]];
+      cell.density = buffer[k++];
+      cell.pressure = buffer[k++];
+      cell.velocity.x = buffer[k++];
+      cell.velocity.y = buffer[k++];
+      for(boost::container::flat_map<string,double>::iterator it =
+	    cell.tracers.begin();
+	  it!=cell.tracers.end();
+	  ++it)
+	it->second = buffer[k++];
+    }
+  }
+}
+
+HaloExchange::HaloExchange(const AngularDecomposition& decomposition,
+			   EosCache& eos_cache,
+			   PhaseProfiler& prof):
+  decomposition_(decomposition),
+  eos_cache_(eos_cache),
+  send_buffers_(decomposition.getNeighbours().size()),
+  receive_buffers_(decomposition.getNeighbours().size()),
+  prof_(prof),
+  phase_(prof.addPhase("halo_exchange")) {}
+
+void HaloExchange::operator()(hdsim& sim)
+{
+  const vector<AngularDecomposition::Neighbour>& neighbours =
+    decomposition_.getNeighbours();
+  if(neighbours.empty())
+    return;
+  const PhaseProfiler::ScopedTimer timer(prof_, phase_);
+  vector<ComputationalCell>& cells = sim.getAllCells();
+  const size_t stride = values_per_cell(cells.front());
+  for(size_t i=0;i<neighbours.size();++i){
+    pack(cells, neighbours[i].send, send_buffers_[i]);
+    receive_buffers_[i].resize(stride*neighbours[i].receive.size());
+  }
+#ifdef WITH_MPI
+  vector<MPI_Request> requests;
+  requests.reserve(2*neighbours.size());
+  for(size_t i=0;i<neighbours.size();++i){
+    if(!receive_buffers_[i].empty()){
+      requests.push_back(MPI_Request());
+      MPI_Irecv(&receive_buffers_[i][0],
+		static_cast<int>(receive_buffers_[i].size()),
+		MPI_DOUBLE, neighbours[i].rank, 0, MPI_COMM_WORLD,
+		&requests.back());
+    }
+    if(!send_buffers_[i].empty()){
+      requests.push_back(MPI_Request());
+      MPI_Isend(&send_buffers_[i][0],
+		static_cast<int>(send_buffers_[i].size()),
+		MPI_DOUBLE, neighbours[i].rank, 0, MPI_COMM_WORLD,
+		&requests.back());
+    }
+  }
+  if(!requests.empty())
+    MPI_Waitall(static_cast<int>(requests.size()),
+		&requests[0],
+		MPI_STATUSES_IGNORE);
+#endif
+  const CacheData& cd = sim.getCacheData();
+  vector<Extensive>& extensives = sim.getAllExtensives();
+  for(size_t i=0;i<neighbours.size();++i){
+    const vector<size_t>& indices = neighbours[i].receive;
+    unpack(receive_buffers_[i], indices, cells);
+    for(size_t j=0;j<indices.size();++j){
+      const size_t index = indices[j];
+      const ComputationalCell& cell = cells[index];
+      extensives[index] = cell_extensive
+	(cell,
+	 cd.volumes[index],
+	 eos_cache_.dp2state(index,
+			     cell.density,
+			     cell.pressure,
+			     cell.tracers).energy);
+    }
+  }
+}
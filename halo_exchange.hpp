@@ -0,0 +1,41 @@
+#ifndef HALO_EXCHANGE_HPP
+#define HALO_EXCHANGE_HPP 1
+
+#include "source/newtonian/test_2d/main_loop_2d.hpp"
+#include "angular_decomposition.hpp"
+#include "phase_profiler.hpp"
+#include "eos_cache.hpp"
+
+/*! \brief Copies the cells of this rank into the halos of its neighbours
+  \details Runs after the other manipulations, so the halo cells receive
+  their final values for the cycle. Density, pressure, velocity and all
+  tracers are sent, in the order of the tracer map, which is the same on
+  every rank. The extensives of the halo cells are recalculated afterwards,
+  through the equation of state cache, so they enter the next cycle
+  consistent. Does nothing when the run is not divided.
+ */
+class HaloExchange: public Manipulate
+{
+public:
+
+  /*! \brief Class constructor
+    \param decomposition Decomposition of the mesh
+    \param eos_cache Equation of state, with the per cell results
+    \param prof Profiler
+   */
+  HaloExchange(const AngularDecomposition& decomposition,
+	       EosCache& eos_cache,
+	       PhaseProfiler& prof);
+
+  void operator()(hdsim& sim);
+
+private:
+  const AngularDecomposition& decomposition_;
+  EosCache& eos_cache_;
+  vector<vector<double> > send_buffers_;
+  vector<vector<double> > receive_buffers_;
+  PhaseProfiler& prof_;
+  const size_t phase_;
+};
+
+#endif // HALO_EXCHANGE_HPP
@@ -0,0 +1,233 @@
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <iostream>
+#include <unistd.h>
+#include "init_cond_cache.hpp"
+#include "create_pressure_reference.hpp"
+#include "vector_io.hpp"
+#include "fnv_hash.hpp"
+
+using std::ifstream;
+using std::ofstream;
+
+namespace {
+
+  const string cache_magic("white_dwarf_nova init_cond 3");
+
+  string calc_key(const Tessellation& tess,
+		  const FermiTable& eos,
+		  const InitialData& id,
+		  const CircularSection& domain)
+  {
+    FnvHash hash;
+    hash.add(id.radius_list);
+    hash.add(id.density_list);
+    hash.add(id.temperature_list);
+    hash.add(id.velocity_list);
+    for(map<string,vector<double> >::const_iterator it=
+	  id.tracers_list.begin();
+	it!=id.tracers_list.end();
+	++it){
+      hash.add(it->first);
+      hash.add(it->second);
+    }
+    const int n = tess.GetPointNo();
+    hash.add(&n, sizeof(n));
+    for(int i=0;i<n;++i){
+      const Vector2D r = tess.GetCellCM(i);
+      hash.add(r.x);
+      hash.add(r.y);
+    }
+    hash.add(domain.getRadii().first);
+    hash.add(domain.getRadii().second);
+    hash.add(domain.getAngles().first);
+    hash.add(domain.getAngles().second);
+    hash.add(eos.getTableHash());
+    return hash.hex();
+  }
+
+  void write_size(ofstream& f, size_t n)
+  {
+    f.write(reinterpret_cast<const char*>(&n), sizeof(n));
+  }
+
+  void write_string(ofstream& f, const string& s)
+  {
+    write_size(f, s.size());
+    f.write(s.data(), static_cast<std::streamsize>(s.size()));
+  }
+
+  void write_doubles(ofstream& f, const vector<double>& v)
+  {
+    write_size(f, v.size());
+    if(!v.empty())
+      f.write(reinterpret_cast<const char*>(&v[0]),
+	      static_cast<std::streamsize>(v.size()*sizeof(double)));
+  }
+
+  size_t read_size(ifstream& f)
+  {
+    size_t res = 0;
+    f.read(reinterpret_cast<char*>(&res), sizeof(res));
+    return res;
+  }
+
+  string read_string(ifstream& f)
+  {
+    const size_t n = read_size(f);
+    if(!f || n>(1<<20))
+      return string();
+    string res(n, ' ');
+    if(n>0)
+      f.read(&res[0], static_cast<std::streamsize>(n));
+    return res;
+  }
+
+  vector<double> read_doubles(ifstream& f, size_t expected)
+  {
+    const size_t n = read_size(f);
+    if(!f || n!=expected)
+      return vector<double>();
+    vector<double> res(n);
+    if(n>0)
+      f.read(reinterpret_cast<char*>(&res[0]),
+	     static_cast<std::streamsize>(n*sizeof(double)));
+    return res;
+  }
+
+  // Cells are stored column by column, one column per field. Concurrent
+  // runs each write their own temporary file, and the rename is atomic
+  void save_cache(const string& fname,
+		  const vector<ComputationalCell>& cells,
+		  const vector<double>& temperatures,
+		  const vector<double>& pressure_reference)
+  {
+    std::ostringstream ss;
+    ss << fname << "." << getpid() << ".tmp";
+    const string temp_name = ss.str();
+    {
+      ofstream f(temp_name.c_str(), std::ios::binary);
+      write_string(f, cache_magic);
+      write_size(f, cells.size());
+      write_doubles(f, pressure_reference);
+      write_doubles(f, temperatures);
+      vector<double> column(cells.size());
+      for(size_t i=0;i<cells.size();++i)
+	column[i] = cells[i].density;
+      write_doubles(f, column);
+      for(size_t i=0;i<cells.size();++i)
+	column[i] = cells[i].pressure;
+      write_doubles(f, column);
+      for(size_t i=0;i<cells.size();++i)
+	column[i] = cells[i].velocity.x;
+      write_doubles(f, column);
+      for(size_t i=0;i<cells.size();++i)
+	column[i] = cells[i].velocity.y;
+      write_doubles(f, column);
+      const ComputationalCell& first = cells.front();
+      write_size(f, first.tracers.size());
+      for(boost::container::flat_map<string,double>::const_iterator it=
+	    first.tracers.begin();
+	  it!=first.tracers.end();
+	  ++it){
+	write_string(f, it->first);
+	for(size_t i=0;i<cells.size();++i)
+	  column[i] = cells[i].tracers.find(it->first)->second;
+	write_doubles(f, column);
+      }
+      write_size(f, first.stickers.size());
+      for(boost::container::flat_map<string,bool>::const_iterator it=
+	    first.stickers.begin();
+	  it!=first.stickers.end();
+	  ++it){
+	write_string(f, it->first);
+	for(size_t i=0;i<cells.size();++i)
+	  column[i] = cells[i].stickers.find(it->first)->second ? 1 : 0;
+	write_doubles(f, column);
+      }
+      if(!f){
+	f.close();
+	unlink(temp_name.c_str());
+	return;
+      }
+    }
+    rename(temp_name.c_str(), fname.c_str());
+  }
+
+  // Returns false, leaving the outputs in an unspecified state, if the file
+  // is missing or does not match
+  bool load_cache(const string& fname,
+		  size_t n,
+		  size_t n_profile,
+		  vector<ComputationalCell>& cells,
+		  vector<double>& temperatures,
+		  vector<double>& pressure_reference)
+  {
+    ifstream f(fname.c_str(), std::ios::binary);
+    if(!f || read_string(f)!=cache_magic || read_size(f)!=n)
+      return false;
+    pressure_reference = read_doubles(f, n_profile);
+    temperatures = read_doubles(f, n);
+    const vector<double> density = read_doubles(f, n);
+    const vector<double> pressure = read_doubles(f, n);
+    const vector<double> x_velocity = read_doubles(f, n);
+    const vector<double> y_velocity = read_doubles(f, n);
+    if(!f)
+      return false;
+    cells.assign(n, ComputationalCell());
+    for(size_t i=0;i<n;++i){
+      cells[i].density = density[i];
+      cells[i].pressure = pressure[i];
+      cells[i].velocity = Vector2D(x_velocity[i], y_velocity[i]);
+    }
+    const size_t tracer_count = read_size(f);
+    for(size_t j=0;j<tracer_count && f;++j){
+      const string name = read_string(f);
+      const vector<double> column = read_doubles(f, n);
+      if(!f)
+	return false;
+      for(size_t i=0;i<n;++i)
+	cells[i].tracers[name] = column[i];
+    }
+    const size_t sticker_count = read_size(f);
+    for(size_t j=0;j<sticker_count && f;++j){
+      const string name = read_string(f);
+      const vector<double> column = read_doubles(f, n);
+      if(!f)
+	return false;
+      for(size_t i=0;i<n;++i)
+	cells[i].stickers[name] = column[i]>0.5;
+    }
+    return static_cast<bool>(f);
+  }
+}
+
+vector<ComputationalCell> cached_init_cond(const Tessellation& tess,
+					   EosCache& eos_cache,
+					   const InitialData& id,
+					   const CircularSection& domain,
+					   const string& directory)
+{
+  const FermiTable& eos = eos_cache.getEOS();
+  const string fname = directory + "/init_cond_" +
+    calc_key(tess, eos, id, domain) + ".bin";
+  const size_t n = static_cast<size_t>(tess.GetPointNo());
+  vector<ComputationalCell> res;
+  vector<double> temperatures;
+  vector<double> pressure_reference;
+  if(load_cache(fname, n, id.radius_list.size(),
+		res, temperatures, pressure_reference)){
+    std::cout << "initial conditions read from " << fname << std::endl;
+    save_txt("pressure_reference.txt", pressure_reference);
+    eos_cache.seedTemperatures(temperatures);
+    return res;
+  }
+  pressure_reference = create_pressure_reference(eos, id);
+  save_txt("pressure_reference.txt", pressure_reference);
+  res = calc_init_cond(tess, eos, id, domain, temperatures);
+  if(!res.empty())
+    save_cache(fname, res, temperatures, pressure_reference);
+  eos_cache.seedTemperatures(temperatures);
+  return res;
+}
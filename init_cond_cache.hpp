@@ -0,0 +1,28 @@
+#ifndef INIT_COND_CACHE_HPP
+#define INIT_COND_CACHE_HPP 1
+
+#include "calc_init_cond.hpp"
+#include "circular_section.hpp"
+#include "eos_cache.hpp"
+
+/*! \brief Initial conditions, reused from a previous run with the same inputs
+  \details The key is a hash of the profiles, the cell centres, the domain
+  and the equation of state table. On a miss the cells and the pressure
+  reference are computed and stored in init_cond_<key>.bin, in a directory
+  that may be shared by concurrent runs. Either way pressure_reference.txt
+  is written to the working directory, as calc_init_cond used to, and the
+  cell temperatures seed the equation of state cache.
+  \param tess Tessellation
+  \param eos_cache Equation of state, with the per cell results
+  \param id Initial profiles
+  \param domain Region of live cells
+  \param directory Directory of the cache files
+  \return Initial cells
+ */
+vector<ComputationalCell> cached_init_cond(const Tessellation& tess,
+					   EosCache& eos_cache,
+					   const InitialData& id,
+					   const CircularSection& domain,
+					   const string& directory);
+
+#endif // INIT_COND_CACHE_HPP
@@ -52,6 +52,8 @@
 ! =================================================================
     if_screen=0
     tmp_nse=6.d9
+! the screening parameters are shared by all threads, so fill them here
+    call screen_init
     print 113,if_screen,tmp_nse
 113 format(' initnet : if_screen=',i3,' tmp_nse=',es12.4)
     print*,' end initnet '
@@ -1,38 +1,75 @@
 #include "inner_bc.hpp"
 #include "source/newtonian/two_dimensional/simple_flux_calculator.hpp"
 #include "safe_retrieve.hpp"
+#include "angular_decomposition.hpp"
 
 namespace {
-  double calc_tracer_flux(const Edge& edge,
-			  const Tessellation& tess,
-			  const vector<ComputationalCell>& cells,
-			  const string& name,
-			  const Conserved& hf)
+  // Upwind cell of an edge, or -1 if no tracers flow through it
+  int donor_cell(const Edge& edge,
+		 const Tessellation& tess,
+		 const Conserved& hf)
   {
-    if(hf.Mass>0 && 
-       edge.neighbors.first>0 && 
-       edge.neighbors.first<tess.GetPointNo()){
-      assert(cells.at(static_cast<size_t>(edge.neighbors.first)).tracers.count(name)==1);
-      return hf.Mass*
-	cells.at(static_cast<size_t>(edge.neighbors.first)).tracers.find(name)->second;
-    }
-    if(hf.Mass<0 && 
-       edge.neighbors.second>0 && 
-       edge.neighbors.second<tess.GetPointNo()){
-      assert(cells.at(static_cast<size_t>(edge.neighbors.second)).tracers.count(name)==1);
-      return hf.Mass*
-	cells.at(static_cast<size_t>(edge.neighbors.second)).tracers.find(name)->second;
+    if(hf.Mass>0 &&
+       edge.neighbors.first>0 &&
+       edge.neighbors.first<tess.GetPointNo())
+      return edge.neighbors.first;
+    if(hf.Mass<0 &&
+       edge.neighbors.second>0 &&
+       edge.neighbors.second<tess.GetPointNo())
+      return edge.neighbors.second;
+    return -1;
+  }
+
+  // Tracers of each cell as one row, in the order of the first cell
+  void gather_tracers(const vector<ComputationalCell>& cells,
+		      vector<double>& res)
+  {
+    const boost::container::flat_map<string,double>& layout =
+      cells.front().tracers;
+    const size_t n = layout.size();
+    res.resize(cells.size()*n);
+    const int n_cells = static_cast<int>(cells.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for(int j=0;j<n_cells;++j){
+      const size_t i = static_cast<size_t>(j);
+      const boost::container::flat_map<string,double>& tracers =
+	cells[i].tracers;
+      assert(tracers.size()==n);
+      size_t k = 0;
+      for(boost::container::flat_map<string,double>::const_iterator it =
+	    tracers.begin();
+	  it!=tracers.end();
+	  ++it, ++k){
+	assert(it->first==layout.nth(k)->first);
+	res[i*n+k] = it->second;
+      }
     }
-    return 0; 
   }
 }
 
 InnerBC::InnerBC(const RiemannSolver& rs,
 		 const string& ghost,
-		 const CoreAtmosphereGravity& cag):
+		 const CoreAtmosphereGravity& cag,
+		 EosCache& eos_cache,
+		 PhaseProfiler& prof,
+		 bool batch_bulk):
   rs_(rs),
   ghost_(ghost),
-  cag_(cag) {}
+  cag_(cag),
+  eos_cache_(eos_cache),
+  prof_(prof),
+  phase_(prof.addPhase("flux")),
+  batch_bulk_(batch_bulk),
+  bulk_solver_(),
+  bulk_batch_(),
+  bulk_edges_(),
+  cell_energies_(),
+  cell_sound_speeds_(),
+  cell_accelerations_(),
+  cell_tracers_(),
+  tracer_fluxes_() {}
 
 namespace {
   const vector<pair<double,double> > calc_radius_mass_list
@@ -43,7 +80,8 @@ namespace {
     vector<pair<double,double> > res;
     for(size_t i=0;i<cell_list.size();++i){
       if(!safe_retrieve(cell_list[i].stickers,
-			string("ghost")))
+			string("ghost")) &&
+	 !is_halo(cell_list[i]))
 	res.push_back
 	  (pair<double,double>
 	   (abs(tess.GetCellCM(static_cast<int>(i))),
@@ -59,10 +97,11 @@ vector<Extensive> InnerBC::operator()
    const vector<ComputationalCell>& cells,
    const vector<Extensive>& extensives,
    const CacheData& /*cd*/,
-   const EquationOfState& eos,
+   const EquationOfState& /*eos*/,
    const double /*time*/,
    const double /*dt*/) const
 {
+  const PhaseProfiler::ScopedTimer timer(prof_, phase_);
   const CoreAtmosphereGravity::EnclosedMassCalculator emc
     (cag_.getCoreMass(),
      calc_radius_mass_list(tess,
@@ -72,28 +111,65 @@ vector<Extensive> InnerBC::operator()
      cag_.getSection2Shell());
   const CoreAtmosphereGravity::AccelerationCalculator ac
     (cag_.getGravitationConstant(), emc);
-  vector<Extensive> res(tess.getAllEdges().size());
-  for(size_t i=0;i<tess.getAllEdges().size();++i){
-    const Conserved hydro_flux =
-      calcHydroFlux(tess,point_velocities,
-		    cells, eos, i,
-		    ac);
-    res.at(i).mass = hydro_flux.Mass;
-    res.at(i).momentum = hydro_flux.Momentum;
-    res.at(i).energy = hydro_flux.Energy;
-    for(boost::container::flat_map<string,double>::const_iterator it =
-	  cells.front().tracers.begin();
-	it!=cells.front().tracers.end();
-	++it)
-      res.at(i).tracers[it->first] =
-	calc_tracer_flux(tess.getAllEdges().at(i),
-			 tess,cells,it->first,hydro_flux);
+  vector<Conserved> hydro_fluxes(tess.getAllEdges().size());
+  // Boundary edges, and all edges when batching is off, stay on this
+  // thread, since they call the cache and may throw
+  bulk_edges_.clear();
+  for(size_t i=0;i<hydro_fluxes.size();++i){
+    if(batch_bulk_ && isBulk(tess, cells, i))
+      bulk_edges_.push_back(i);
+    else
+      hydro_fluxes[i] =
+	calcHydroFlux(tess,point_velocities,
+		      cells, eos_cache_, i,
+		      ac);
+  }
+  calcBulkFluxes(tess, point_velocities, cells, ac, hydro_fluxes);
+  calcTracerFluxes(tess, cells, hydro_fluxes);
+  // Every edge starts with the species of the first cell, so the fluxes
+  // are copied in order without lookups or insertions
+  Extensive prototype;
+  prototype.tracers = cells.front().tracers;
+  const size_t n_species = prototype.tracers.size();
+  vector<Extensive> res(hydro_fluxes.size(), prototype);
+  const int n_edges = static_cast<int>(res.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for(int j=0;j<n_edges;++j){
+    const size_t i = static_cast<size_t>(j);
+    const Conserved& hydro_flux = hydro_fluxes[i];
+    res[i].mass = hydro_flux.Mass;
+    res[i].momentum = hydro_flux.Momentum;
+    res[i].energy = hydro_flux.Energy;
+    const double* tracer_flux = &tracer_fluxes_[i*n_species];
+    size_t k = 0;
+    for(boost::container::flat_map<string,double>::iterator it =
+	  res[i].tracers.begin();
+	it!=res[i].tracers.end();
+	++it, ++k)
+      it->second = tracer_flux[k];
   }
   return res;
 }
 
 namespace {
 
+  // Energy and sound speed from one inversion, unlike convert_to_primitive
+  Primitive to_primitive(size_t index,
+			 const vector<ComputationalCell>& cells,
+			 EosCache& eos_cache)
+  {
+    const ComputationalCell& cell = cells.at(index);
+    const FermiTable::ThermodynamicVariables tv =
+      eos_cache.dp2state(index, cell.density, cell.pressure, cell.tracers);
+    return Primitive(cell.density,
+		     cell.pressure,
+		     cell.velocity,
+		     tv.energy,
+		     tv.sound_speed);
+  }
+
   Primitive boost(const Primitive& origin,
 		  const Vector2D& v)
   {
@@ -162,26 +238,24 @@ namespace {
   }
 
   Primitive gravinterpolate
-  (const ComputationalCell& origin,
+  (size_t index,
+   const ComputationalCell& origin,
    const Vector2D& cm,
    const Vector2D& centroid,
    const Vector2D& acc,
-   const EquationOfState& eos)
+   EosCache& eos_cache)
   {
-    const double energy =
-      eos.dp2e(origin.density,
-	       origin.pressure,
-	       origin.tracers);
-    const double sound_speed =
-      eos.dp2c(origin.density,
-	       origin.pressure,
-	       origin.tracers);
+    const FermiTable::ThermodynamicVariables tv =
+      eos_cache.dp2state(index,
+			 origin.density,
+			 origin.pressure,
+			 origin.tracers);
     return Primitive
       (origin.density,
        origin.pressure + origin.density*ScalarProd(acc,centroid-cm),
        origin.velocity,
-       energy,
-       sound_speed);
+       tv.energy,
+       tv.sound_speed);
   }
 
   Conserved bulk_riemann
@@ -189,7 +263,7 @@ namespace {
    const Tessellation& tess,
    const vector<Vector2D>& point_velocities,
    const vector<ComputationalCell>& cells,
-   const EquationOfState& eos,
+   EosCache& eos_cache,
    const Edge& edge,
    const CoreAtmosphereGravity::AccelerationCalculator& ac)
   {
@@ -207,18 +281,20 @@ namespace {
       static_cast<size_t>(edge.neighbors.second);
     const Primitive left =
       gravinterpolate
-      (cells[left_index],
+      (left_index,
+       cells[left_index],
        left_pos,
        centroid,
        left_acc,
-       eos);
+       eos_cache);
     const Primitive right =
       gravinterpolate
-      (cells[right_index],
+      (right_index,
+       cells[right_index],
        right_pos,
        centroid,
        right_acc,
-       eos);
+       eos_cache);
     const Vector2D p = Parallel(edge);
     const Vector2D n =
       tess.GetMeshPoint(edge.neighbors.second) -
@@ -252,7 +328,7 @@ const Conserved InnerBC::calcHydroFlux
 (const Tessellation& tess,
  const vector<Vector2D>& point_velocities,
  const vector<ComputationalCell>& cells,
- const EquationOfState& eos,
+ EosCache& eos_cache,
  const size_t i,
  const CoreAtmosphereGravity::AccelerationCalculator& ac) const
 {
@@ -266,10 +342,10 @@ const Conserved InnerBC::calcHydroFlux
       (rs_,
        tess.GetMeshPoint(edge.neighbors.second),
        edge,
-       convert_to_primitive
-       (cells.at
-	(static_cast<size_t>(edge.neighbors.second)),
-	eos),
+       to_primitive
+       (static_cast<size_t>(edge.neighbors.second),
+	cells,
+	eos_cache),
        Vector2D(0,0),
        false);
   if(!flags.second)
@@ -277,10 +353,10 @@ const Conserved InnerBC::calcHydroFlux
       (rs_,
        tess.GetMeshPoint(edge.neighbors.first),
        edge,
-       convert_to_primitive
-       (cells.at
-	(static_cast<size_t>(edge.neighbors.first)),
-	eos),
+       to_primitive
+       (static_cast<size_t>(edge.neighbors.first),
+	cells,
+	eos_cache),
        Vector2D(0,0),
        true);
   const size_t left_index =
@@ -298,13 +374,13 @@ const Conserved InnerBC::calcHydroFlux
       (rs_,
        tess.GetMeshPoint(edge.neighbors.second),
        edge,
-       convert_to_primitive(right_cell,eos),
+       to_primitive(right_index,cells,eos_cache),
        false) :
       support_riemann
       (rs_,
        tess.GetMeshPoint(edge.neighbors.second),
        edge,
-       convert_to_primitive(right_cell,eos),
+       to_primitive(right_index,cells,eos_cache),
        Vector2D(0,0),
        false);
   }
@@ -315,13 +391,13 @@ const Conserved InnerBC::calcHydroFlux
       (rs_,
        tess.GetMeshPoint(edge.neighbors.first),
        edge,
-       convert_to_primitive(left_cell,eos),
+       to_primitive(left_index,cells,eos_cache),
        true) :
       support_riemann
       (rs_,
        tess.GetMeshPoint(edge.neighbors.first),
        edge,
-       convert_to_primitive(left_cell,eos),
+       to_primitive(left_index,cells,eos_cache),
        Vector2D(0,0),
        true);
   }
@@ -330,7 +406,158 @@ const Conserved InnerBC::calcHydroFlux
      tess,
      point_velocities,
      cells,
-     eos,
+     eos_cache,
      edge,
      ac);
 }
+
+bool InnerBC::isBulk(const Tessellation& tess,
+		     const vector<ComputationalCell>& cells,
+		     size_t i) const
+{
+  const Edge& edge = tess.GetEdge(static_cast<int>(i));
+  return edge.neighbors.first>=0 &&
+    edge.neighbors.first<tess.GetPointNo() &&
+    edge.neighbors.second>=0 &&
+    edge.neighbors.second<tess.GetPointNo() &&
+    !safe_retrieve(cells.at(static_cast<size_t>(edge.neighbors.first)).stickers,
+		   ghost_) &&
+    !safe_retrieve(cells.at(static_cast<size_t>(edge.neighbors.second)).stickers,
+		   ghost_);
+}
+
+void InnerBC::calcCellStates
+(const Tessellation& tess,
+ const vector<ComputationalCell>& cells,
+ const CoreAtmosphereGravity::AccelerationCalculator& ac) const
+{
+  const size_t n = static_cast<size_t>(tess.GetPointNo());
+  cell_energies_.resize(n);
+  cell_sound_speeds_.resize(n);
+  cell_accelerations_.resize(n);
+  // Each cell has its own cache entry, so the inversions are independent
+  eos_cache_.reserve(n);
+  const int n_cells = static_cast<int>(n);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for(int j=0;j<n_cells;++j){
+    const size_t i = static_cast<size_t>(j);
+    const ComputationalCell& cell = cells[i];
+    if(safe_retrieve(cell.stickers,ghost_))
+      continue;
+    const FermiTable::ThermodynamicVariables tv =
+      eos_cache_.dp2state(i, cell.density, cell.pressure, cell.tracers);
+    cell_energies_[i] = tv.energy;
+    cell_sound_speeds_[i] = tv.sound_speed;
+    cell_accelerations_[i] = ac(tess.GetCellCM(static_cast<int>(i)));
+  }
+}
+
+void InnerBC::gatherSide(size_t index,
+			 const Vector2D& centroid,
+			 const Vector2D& cm,
+			 const ComputationalCell& cell,
+			 const Vector2D& n,
+			 const Vector2D& p,
+			 BulkHllc::States& states,
+			 size_t k) const
+{
+  // Same primitives as gravinterpolate, rotated as in
+  // rotate_solve_rotate_back
+  states.density[k] = cell.density;
+  states.pressure[k] = cell.pressure +
+    cell.density*ScalarProd(cell_accelerations_[index],centroid-cm);
+  states.energy[k] = cell_energies_[index];
+  states.sound_speed[k] = cell_sound_speeds_[index];
+  states.normal_velocity[k] = Projection(cell.velocity, n);
+  states.parallel_velocity[k] = Projection(cell.velocity, p);
+}
+
+void InnerBC::calcBulkFluxes
+(const Tessellation& tess,
+ const vector<Vector2D>& point_velocities,
+ const vector<ComputationalCell>& cells,
+ const CoreAtmosphereGravity::AccelerationCalculator& ac,
+ vector<Conserved>& hydro_fluxes) const
+{
+  if(bulk_edges_.empty())
+    return;
+  calcCellStates(tess, cells, ac);
+  bulk_batch_.resize(bulk_edges_.size());
+  // Each edge only writes its own slot, so the fluxes do not depend on
+  // the number of threads
+  const int n_bulk = static_cast<int>(bulk_edges_.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for(int j=0;j<n_bulk;++j){
+    const size_t k = static_cast<size_t>(j);
+    const Edge& edge = tess.GetEdge(static_cast<int>(bulk_edges_[k]));
+    const size_t left_index = static_cast<size_t>(edge.neighbors.first);
+    const size_t right_index = static_cast<size_t>(edge.neighbors.second);
+    const Vector2D& left_pos = tess.GetCellCM(edge.neighbors.first);
+    const Vector2D& right_pos = tess.GetCellCM(edge.neighbors.second);
+    const Vector2D centroid =
+      0.5*(edge.vertices.first+edge.vertices.second);
+    const Vector2D p = Parallel(edge);
+    const Vector2D n =
+      tess.GetMeshPoint(edge.neighbors.second) -
+      tess.GetMeshPoint(edge.neighbors.first);
+    gatherSide(left_index, centroid, left_pos, cells[left_index],
+	       n, p, bulk_batch_.left, k);
+    gatherSide(right_index, centroid, right_pos, cells[right_index],
+	       n, p, bulk_batch_.right, k);
+    bulk_batch_.face_velocity[k] = Projection
+      (tess.CalcFaceVelocity
+       (point_velocities.at(left_index),
+	point_velocities.at(right_index),
+	left_pos,
+	right_pos,
+	calc_centroid(edge)),n);
+  }
+  bulk_solver_(bulk_batch_);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for(int j=0;j<n_bulk;++j){
+    const size_t k = static_cast<size_t>(j);
+    const Edge& edge = tess.GetEdge(static_cast<int>(bulk_edges_[k]));
+    const Vector2D p = Parallel(edge);
+    const Vector2D n =
+      tess.GetMeshPoint(edge.neighbors.second) -
+      tess.GetMeshPoint(edge.neighbors.first);
+    hydro_fluxes[bulk_edges_[k]] =
+      Conserved(bulk_batch_.mass[k],
+		bulk_batch_.normal_momentum[k]*n/abs(n)+
+		bulk_batch_.parallel_momentum[k]*p/abs(p),
+		bulk_batch_.energy[k]);
+  }
+}
+
+void InnerBC::calcTracerFluxes
+(const Tessellation& tess,
+ const vector<ComputationalCell>& cells,
+ const vector<Conserved>& hydro_fluxes) const
+{
+  gather_tracers(cells, cell_tracers_);
+  const size_t n_species = cells.front().tracers.size();
+  tracer_fluxes_.assign(hydro_fluxes.size()*n_species, 0);
+  const int n_edges = static_cast<int>(hydro_fluxes.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for(int j=0;j<n_edges;++j){
+    const size_t i = static_cast<size_t>(j);
+    const int donor =
+      donor_cell(tess.GetEdge(static_cast<int>(i)), tess, hydro_fluxes[i]);
+    if(donor<0)
+      continue;
+    const double mass_flux = hydro_fluxes[i].Mass;
+    const double* source =
+      &cell_tracers_[static_cast<size_t>(donor)*n_species];
+    double* flux = &tracer_fluxes_[i*n_species];
+    for(size_t k=0;k<n_species;++k)
+      flux[k] = mass_flux*source[k];
+  }
+}
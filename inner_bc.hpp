@@ -4,7 +4,23 @@
 #include "source/newtonian/two_dimensional/flux_calculator_2d.hpp"
 #include "source/newtonian/common/riemann_solver.hpp"
 #include "core_atmosphere_gravity.hpp"
+#include "phase_profiler.hpp"
+#include "eos_cache.hpp"
+#include "bulk_hllc.hpp"
 
+/*! \brief Flux calculator with a supported inner boundary
+  \details Primitives come from the full state call of the tabulated
+  equation of state, which is held here rather than taken from hdsim so
+  energy and sound speed share one inversion. The results are cached per
+  cell, so the several edges of a cell, and cells left unchanged since the
+  cell update, do not repeat it. Edges between two live cells are gathered
+  into one batch for BulkHllc, and only boundary edges go through the
+  Riemann solver given here one at a time. The equation of state and
+  gravity are evaluated once per cell on the calling thread, after which
+  the bulk edges and tracer fluxes are split statically between OpenMP
+  threads, each writing only its own edges, so the result is the same for
+  any number of threads
+ */
 class InnerBC: public FluxCalculator
 {
 public:
@@ -12,7 +28,10 @@ public:
   InnerBC
   (const RiemannSolver& rs,
    const string& ghost,
-   const CoreAtmosphereGravity& cag);
+   const CoreAtmosphereGravity& cag,
+   EosCache& eos_cache,
+   PhaseProfiler& prof,
+   bool batch_bulk=true);
 
   vector<Extensive> operator()
   (const Tessellation& tess,
@@ -20,7 +39,7 @@ public:
    const vector<ComputationalCell>& cells,
    const vector<Extensive>& extensives,
    const CacheData& cd,
-   const EquationOfState& eos,
+   const EquationOfState& /*eos*/,
    const double /*time*/,
    const double /*dt*/) const;
 
@@ -28,12 +47,59 @@ private:
   const RiemannSolver& rs_;
   const string ghost_;
   const CoreAtmosphereGravity& cag_;
+  EosCache& eos_cache_;
+  PhaseProfiler& prof_;
+  const size_t phase_;
+  //! \brief Solve the edges between live cells in one batch
+  const bool batch_bulk_;
+  const BulkHllc bulk_solver_;
+  mutable BulkHllc::Batch bulk_batch_;
+  mutable vector<size_t> bulk_edges_;
+  //! \brief Energy of each live cell, from the cache before the parallel loops
+  mutable vector<double> cell_energies_;
+  mutable vector<double> cell_sound_speeds_;
+  //! \brief Gravity at each live cell's centre of mass
+  mutable vector<Vector2D> cell_accelerations_;
+  //! \brief Tracers per cell, one row of species each
+  mutable vector<double> cell_tracers_;
+  //! \brief Upwind tracer fluxes per edge, one row of species each
+  mutable vector<double> tracer_fluxes_;
+
+  bool isBulk(const Tessellation& tess,
+	      const vector<ComputationalCell>& cells,
+	      size_t i) const;
+
+  void calcCellStates
+  (const Tessellation& tess,
+   const vector<ComputationalCell>& cells,
+   const CoreAtmosphereGravity::AccelerationCalculator& ac) const;
+
+  void gatherSide(size_t index,
+		  const Vector2D& centroid,
+		  const Vector2D& cm,
+		  const ComputationalCell& cell,
+		  const Vector2D& n,
+		  const Vector2D& p,
+		  BulkHllc::States& states,
+		  size_t k) const;
+
+  void calcBulkFluxes
+  (const Tessellation& tess,
+   const vector<Vector2D>& point_velocities,
+   const vector<ComputationalCell>& cells,
+   const CoreAtmosphereGravity::AccelerationCalculator& ac,
+   vector<Conserved>& hydro_fluxes) const;
+
+  void calcTracerFluxes
+  (const Tessellation& tess,
+   const vector<ComputationalCell>& cells,
+   const vector<Conserved>& hydro_fluxes) const;
 
   const Conserved calcHydroFlux
   (const Tessellation& tess,
    const vector<Vector2D>& point_velocities,
    const vector<ComputationalCell>& cells,
-   const EquationOfState& eos,
+   EosCache& eos_cache,
    const size_t i,
    const CoreAtmosphereGravity::AccelerationCalculator& ac) const;
 };
@@ -0,0 +1,22 @@
+#include <unistd.h>
+#include <climits>
+#include "launch_directory.hpp"
+
+const string& launch_directory(void)
+{
+  static string res;
+  if(res.empty()){
+    char buf[PATH_MAX];
+    if(!getcwd(buf, sizeof(buf)))
+      throw "failed to read the working directory";
+    res = buf;
+  }
+  return res;
+}
+
+string from_launch_directory(const string& path)
+{
+  if(!path.empty() && path[0]=='/')
+    return path;
+  return launch_directory() + "/" + path;
+}
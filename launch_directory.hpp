@@ -0,0 +1,22 @@
+#ifndef LAUNCH_DIRECTORY_HPP
+#define LAUNCH_DIRECTORY_HPP 1
+
+#include <string>
+
+using std::string;
+
+/*! \brief Working directory the program was started in
+  \details Recorded on the first call, so it must be called before any
+  change of directory. Batch runs and MPI ranks work in subdirectories,
+  and use it for files shared between them.
+  \return Absolute path
+ */
+const string& launch_directory(void);
+
+/*! \brief Resolves a path against the launch directory
+  \param path Absolute path, or path relative to the launch directory
+  \return Absolute path
+ */
+string from_launch_directory(const string& path);
+
+#endif // LAUNCH_DIRECTORY_HPP
@@ -1,18 +1,24 @@
 #include "lazy_cell_updater.hpp"
+#include "angular_decomposition.hpp"
 
-LazyCellUpdater::LazyCellUpdater(void) {}
+LazyCellUpdater::LazyCellUpdater(EosCache& eos_cache,
+				 PhaseProfiler& prof):
+  eos_cache_(eos_cache),
+  prof_(prof), phase_(prof.addPhase("cell_update")) {}
 
 vector<ComputationalCell> LazyCellUpdater::operator()
   (const Tessellation& /*tess*/,
    const PhysicalGeometry& /*pg*/,
-   const EquationOfState& eos,
+   const EquationOfState& /*eos*/,
    const vector<Extensive>& extensives,
    const vector<ComputationalCell>& old,
    const CacheData& cd) const
 {
+  const PhaseProfiler::ScopedTimer timer(prof_, phase_);
   vector<ComputationalCell> res = old;
   for(size_t i=0;i<extensives.size();++i){
-    if(old.at(i).stickers.find("ghost")->second)
+    // Halo cells are overwritten by their owners after the step
+    if(old.at(i).stickers.find("ghost")->second || is_halo(old.at(i)))
       continue;
     const double volume = cd.volumes[i];
     res.at(i).density = extensives.at(i).mass/volume;
@@ -25,7 +31,9 @@ vector<ComputationalCell> LazyCellUpdater::operator()
 	it!=extensives.at(i).tracers.end();
 	++it)
       res.at(i).tracers[it->first] = it->second/extensives.at(i).mass;
-    res.at(i).pressure = eos.de2p(res.at(i).density, thermal_energy, res.at(i).tracers);
+    const FermiTable::ThermodynamicVariables tv =
+      eos_cache_.de2state(i, res.at(i).density, thermal_energy, res.at(i).tracers);
+    res.at(i).pressure = tv.pressure;
   }
   return res;
 }
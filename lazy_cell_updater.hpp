@@ -2,20 +2,32 @@
 #define LAZY_CELL_UPDATER_HPP 1
 
 #include "source/newtonian/two_dimensional/simple_cell_updater.hpp"
+#include "phase_profiler.hpp"
+#include "eos_cache.hpp"
 
+/*! \brief Recovers the primitives from the extensives
+  \details Inversions go through the equation of state cache, so each
+  starts from the cell's last temperature, and cells whose density, energy
+  and composition barely changed reuse their last result
+ */
 class LazyCellUpdater: public CellUpdater
 {
 public:
 
-  LazyCellUpdater(void);
+  LazyCellUpdater(EosCache& eos_cache, PhaseProfiler& prof);
 
   vector<ComputationalCell> operator()
   (const Tessellation& /*tess*/,
    const PhysicalGeometry& /*pg*/,
-   const EquationOfState& eos,
+   const EquationOfState& /*eos*/,
    const vector<Extensive>& extensives,
    const vector<ComputationalCell>& old,
    const CacheData& cd) const;
+
+private:
+  EosCache& eos_cache_;
+  PhaseProfiler& prof_;
+  const size_t phase_;
 };
 
 #endif // LAZY_CELL_UPDATER_HPP
@@ -0,0 +1,29 @@
+#include <limits>
+#include <algorithm>
+#include "lazy_cfl.hpp"
+
+LazyCFL::LazyCFL(double cfl, EosCache& eos_cache):
+  cfl_(cfl), eos_cache_(eos_cache) {}
+
+double LazyCFL::operator()
+  (const Tessellation& tess,
+   const vector<ComputationalCell>& cells,
+   const EquationOfState& /*eos*/,
+   const vector<Vector2D>& point_velocities,
+   const double /*time*/) const
+{
+  double res = std::numeric_limits<double>::max();
+  for(int i=0;i<tess.GetPointNo();++i){
+    const size_t index = static_cast<size_t>(i);
+    const ComputationalCell& cell = cells[index];
+    const double sound_speed =
+      eos_cache_.dp2state(index,
+			  cell.density,
+			  cell.pressure,
+			  cell.tracers).sound_speed;
+    res = std::min(res,
+		   tess.GetWidth(i)/
+		   (sound_speed+abs(cell.velocity-point_velocities[index])));
+  }
+  return cfl_*res;
+}
@@ -0,0 +1,34 @@
+#ifndef LAZY_CFL_HPP
+#define LAZY_CFL_HPP 1
+
+#include "source/newtonian/two_dimensional/time_step_function.hpp"
+#include "eos_cache.hpp"
+
+/*! \brief Courant time step, as SimpleCFL computes it
+  \details The sound speeds come from the equation of state cache, so
+  cells that did not change are not inverted again, and the others start
+  from their last temperature
+ */
+class LazyCFL: public TimeStepFunction
+{
+public:
+
+  /*! \brief Class constructor
+    \param cfl Courant number
+    \param eos_cache Equation of state, with the per cell results
+   */
+  LazyCFL(double cfl, EosCache& eos_cache);
+
+  double operator()
+  (const Tessellation& tess,
+   const vector<ComputationalCell>& cells,
+   const EquationOfState& /*eos*/,
+   const vector<Vector2D>& point_velocities,
+   const double /*time*/) const;
+
+private:
+  const double cfl_;
+  EosCache& eos_cache_;
+};
+
+#endif // LAZY_CFL_HPP
@@ -5,7 +5,8 @@
 
 using std::string;
 
-LazyExtensiveUpdater::LazyExtensiveUpdater(void) {}
+LazyExtensiveUpdater::LazyExtensiveUpdater(PhaseProfiler& prof):
+  prof_(prof), phase_(prof.addPhase("extensive_update")) {}
 
 void LazyExtensiveUpdater::operator()
 (const vector<Extensive>& fluxes,
@@ -16,6 +17,7 @@ void LazyExtensiveUpdater::operator()
  const vector<ComputationalCell>& cells,
  vector<Extensive>& extensive) const
 {
+  const PhaseProfiler::ScopedTimer timer(prof_, phase_);
   const vector<Edge>& edge_list = tess.getAllEdges();
   for(size_t i=0;i<edge_list.size();++i){
     const Edge& edge = edge_list.at(i);
@@ -2,12 +2,13 @@
 #define LAZY_EXTENSIVE_UPDATER_HPP 1
 
 #include "source/newtonian/two_dimensional/simple_extensive_updater.hpp"
+#include "phase_profiler.hpp"
 
 class LazyExtensiveUpdater: public ExtensiveUpdater
 {
 public:
 
-  LazyExtensiveUpdater(void);
+  explicit LazyExtensiveUpdater(PhaseProfiler& prof);
 
   void operator()
   (const vector<Extensive>& fluxes,
@@ -17,6 +18,10 @@ public:
    const CacheData& cd,
    const vector<ComputationalCell>& cells,
    vector<Extensive>& extensive) const;
+
+private:
+  PhaseProfiler& prof_;
+  const size_t phase_;
 };
 
 #endif // LAZY_EXTENSIVE_UPDATER_HPP
@@ -0,0 +1,136 @@
+"""
+Checks that a run divided between MPI ranks matches an undivided one.
+Run from a simulation directory, with rich built with mpi=1:
+
+python mpi_equivalence.py [ranks] [cycles] [key=value ...]
+
+Both runs start from the same initial conditions and stop after the same
+number of cycles, each in its own directory. The enclosed mass profile,
+the time of every cycle and the final state of every live cell must agree
+to a relative tolerance, since the reductions add in a different order.
+The exit status is nonzero when they do not.
+"""
+
+import os
+import sys
+import subprocess
+
+tolerance = 1e-8
+
+input_keys = ['radius_file',
+              'density_file',
+              'temperature_file',
+              'velocity_file',
+              'eos_table',
+              'burn_table']
+
+default_inputs = ['radius_list.txt',
+                  'density_list.txt',
+                  'temperature_list.txt',
+                  'velocity_list.txt',
+                  'eos_tab.coded',
+                  'alpha_table']
+
+cell_fields = ['density',
+               'pressure',
+               'x_velocity',
+               'y_velocity',
+               'temperature']
+
+def run(ranks, cycles, overrides):
+
+    directory = os.path.abspath('equivalence_%d' % ranks)
+    if not os.path.isdir(directory):
+        os.mkdir(directory)
+    args = ['mpirun', '-np', str(ranks), os.path.abspath('rich'),
+            'max_cycles=%d' % cycles,
+            'checkpoint_interval=1e30',
+            'snapshot_interval=1e30',
+            'radial_profile_interval=1e-30',
+            'init_cond_cache_dir=%s' % os.getcwd()]
+    keys = [item.split('=')[0] for item in overrides]
+    for key, fname in zip(input_keys, default_inputs):
+        if key not in keys:
+            args.append('%s=%s' % (key, os.path.abspath(fname)))
+    subprocess.check_call(args+overrides, cwd=directory)
+    if ranks>1:
+        return [os.path.join(directory, 'rank_%d' % rank)
+                for rank in range(ranks)]
+    return [directory]
+
+def cycle_times(directories):
+
+    import numpy
+
+    return numpy.atleast_2d(
+        numpy.loadtxt(os.path.join(directories[0], 'cycle.txt')))[:,1]
+
+def enclosed_mass(directories):
+
+    import numpy
+
+    with open(os.path.join(directories[0], 'radial_profiles.txt')) as f:
+        columns = f.readline().split()
+    data = numpy.atleast_2d(
+        numpy.loadtxt(os.path.join(directories[0], 'radial_profiles.txt'),
+                      skiprows=1))
+    time = data[:,columns.index('time')]
+    last = data[time==time[-1]]
+    return numpy.cumsum(last[:,columns.index('mass')])
+
+def live_cells(directories):
+
+    import h5py
+    import numpy
+
+    raw = {}
+    for directory in directories:
+        with h5py.File(os.path.join(directory, 'final.h5'), 'r') as f:
+            mask = numpy.array(f['ghost'])<0.5
+            if 'halo' in f:
+                mask = numpy.logical_and(mask, numpy.array(f['halo'])<0.5)
+            for field in ['x_coordinate', 'y_coordinate']+cell_fields:
+                raw.setdefault(field, []).append(numpy.array(f[field])[mask])
+    for field in raw:
+        raw[field] = numpy.concatenate(raw[field])
+    order = numpy.lexsort((raw['y_coordinate'], raw['x_coordinate']))
+    return dict((field, raw[field][order]) for field in raw)
+
+def deviation(actual, expected):
+
+    import numpy
+
+    if actual.shape!=expected.shape:
+        return numpy.inf
+    if actual.size==0:
+        return 0
+    scale = numpy.maximum(numpy.abs(expected).max(), 1e-300)
+    return numpy.abs(actual-expected).max()/scale
+
+def main():
+
+    ranks = int(sys.argv[1]) if len(sys.argv)>1 else 2
+    cycles = int(sys.argv[2]) if len(sys.argv)>2 else 20
+    overrides = sys.argv[3:]
+    serial = run(1, cycles, overrides)
+    divided = run(ranks, cycles, overrides)
+    results = [('enclosed mass',
+                deviation(enclosed_mass(divided), enclosed_mass(serial))),
+               ('cycle times',
+                deviation(cycle_times(divided), cycle_times(serial)))]
+    serial_cells = live_cells(serial)
+    divided_cells = live_cells(divided)
+    for field in ['x_coordinate', 'y_coordinate']+cell_fields:
+        results.append((field,
+                        deviation(divided_cells[field], serial_cells[field])))
+    failed = False
+    for name, value in results:
+        passed = value<=tolerance
+        failed = failed or not passed
+        print('%s: largest relative deviation %g %s' %
+              (name, value, 'ok' if passed else 'FAILED'))
+    return 1 if failed else 0
+
+if __name__ == '__main__':
+
+    sys.exit(main())
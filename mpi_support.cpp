@@ -0,0 +1,77 @@
+#include "mpi_support.hpp"
+#ifdef WITH_MPI
+#include <mpi.h>
+#endif
+
+int mpi_rank(void)
+{
+#ifdef WITH_MPI
+  int res = 0;
+  MPI_Comm_rank(MPI_COMM_WORLD, &res);
+  return res;
+#else
+  return 0;
+#endif
+}
+
+int mpi_size(void)
+{
+#ifdef WITH_MPI
+  int res = 1;
+  MPI_Comm_size(MPI_COMM_WORLD, &res);
+  return res;
+#else
+  return 1;
+#endif
+}
+
+double global_min(double value)
+{
+#ifdef WITH_MPI
+  double res = value;
+  MPI_Allreduce(&value, &res, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+  return res;
+#else
+  return value;
+#endif
+}
+
+vector<double> global_min(const vector<double>& values)
+{
+#ifdef WITH_MPI
+  vector<double> send = values;
+  vector<double> res(values.size(), 0);
+  if(!values.empty())
+    MPI_Allreduce(&send[0], &res[0], static_cast<int>(values.size()),
+		  MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+  return res;
+#else
+  return values;
+#endif
+}
+
+vector<double> global_sum(const vector<double>& values)
+{
+#ifdef WITH_MPI
+  vector<double> send = values;
+  vector<double> res(values.size(), 0);
+  if(!values.empty())
+    MPI_Allreduce(&send[0], &res[0], static_cast<int>(values.size()),
+		  MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+  return res;
+#else
+  return values;
+#endif
+}
+
+bool any_rank(bool value)
+{
+#ifdef WITH_MPI
+  int flag = value ? 1 : 0;
+  int res = 0;
+  MPI_Allreduce(&flag, &res, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+  return res!=0;
+#else
+  return value;
+#endif
+}
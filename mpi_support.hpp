@@ -0,0 +1,43 @@
+#ifndef MPI_SUPPORT_HPP
+#define MPI_SUPPORT_HPP 1
+
+#include <vector>
+
+using std::vector;
+
+/*! \file mpi_support.hpp
+  \brief Reductions over MPI ranks. Builds without WITH_MPI have a single
+  rank, and these return their arguments.
+ */
+
+//! \brief Rank of this process
+int mpi_rank(void);
+
+//! \brief Number of ranks
+int mpi_size(void);
+
+/*! \brief Smallest value over all ranks
+  \param value Value of this rank
+  \return Minimum
+ */
+double global_min(double value);
+
+/*! \brief Elementwise minimum over all ranks
+  \param values Values of this rank, the same length on every rank
+  \return Minima
+ */
+vector<double> global_min(const vector<double>& values);
+
+/*! \brief Elementwise sum over all ranks
+  \param values Values of this rank, the same length on every rank
+  \return Sums
+ */
+vector<double> global_sum(const vector<double>& values);
+
+/*! \brief Checks a condition on all ranks
+  \param value Condition on this rank
+  \return True if it holds on any rank
+ */
+bool any_rank(bool value);
+
+#endif // MPI_SUPPORT_HPP
@@ -1,53 +1,151 @@
+#include <cstdio>
 #include "my_main_loop.hpp"
 #include "temperature_appendix.hpp"
 #include "volume_appendix.hpp"
 #include "energy_appendix.hpp"
 #include "source/newtonian/test_2d/main_loop_2d.hpp"
 #include "source/misc/vector_initialiser.hpp"
-#include "source/newtonian/test_2d/consecutive_snapshots.hpp"
+#include "async_snapshots.hpp"
 #include "write_cycle.hpp"
 #include "source/newtonian/test_2d/multiple_diagnostics.hpp"
 #include "nuclear_burn.hpp"
 #include "atlas_support.hpp"
 #include "filtered_conserved.hpp"
 #include "multiple_manipulation.hpp"
+#include "profile_report.hpp"
+#include "checkpoint.hpp"
+#include "safe_retrieve.hpp"
+#include "halo_exchange.hpp"
+#include "radial_profiles.hpp"
 
 using namespace simulation2d;
 
-void my_main_loop(hdsim& sim, const FermiTable& eos)
+namespace {
+  vector<double> parse_radii(const vector<string>& items)
+  {
+    vector<double> res;
+    for(size_t i=0;i<items.size();++i){
+      double radius = 0;
+      char tail = 0;
+      if(sscanf(items[i].c_str(),"%lf%c",&radius,&tail)!=1)
+	throw "radial_profile_radii: expected a radius, got " + items[i];
+      res.push_back(radius);
+    }
+    return res;
+  }
+}
+
+void my_main_loop(hdsim& sim,
+		  StaticMeshAdvance& advance,
+		  EosCache& eos_cache,
+		  const ReactionNetwork& network,
+		  PhaseProfiler& prof,
+		  const AngularDecomposition& decomposition,
+		  const vector<double>& sample_radii,
+		  const Config& config)
 {
-  write_snapshot_to_hdf5(sim,"initial.h5",
-			 vector<DiagnosticAppendix*>
-			 (1,new TemperatureAppendix(eos)));
-  const double tf = 20;
-  SafeTimeTermination term_cond(tf, 1e6);
+  const string restart_file = config.getString("restart","");
+  map<string,double> state;
+  map<string,vector<double> > arrays;
+  if(restart_file.empty())
+    write_snapshot_to_hdf5(sim,"initial.h5",
+			   vector<DiagnosticAppendix*>
+			   (1,new TemperatureAppendix(eos_cache)));
+  else
+    state = read_checkpoint(restart_file, sim, arrays);
+  const double tf = config.getDouble("final_time",20);
+  const double snapshot_interval =
+    config.getDouble("snapshot_interval",tf/1000);
+  const double snapshots_taken = restart_file.empty() ? 0 :
+    safe_retrieve(state,string("snapshot counter"));
+  SafeTimeTermination term_cond(tf, config.getInt("max_cycles",1000000));
+  AsyncSnapshots* snapshots = new AsyncSnapshots
+    (new ConstantTimeInterval(snapshot_interval,
+			      snapshots_taken*snapshot_interval),
+     new Rubric("snapshot_",".h5"),
+     VectorInitialiser<DiagnosticAppendix*>
+     (new TemperatureAppendix(eos_cache))
+     (new EnergyAppendix(eos_cache))
+     (new VolumeAppendix())(),
+     config.getSize("snapshot_max_pending",2),
+     SnapshotLayout(config.getInt("snapshot_deflate",4),
+		    config.getBool("snapshot_shuffle",true),
+		    config.getSize("snapshot_chunk",1<<16),
+		    config.getList("snapshot_fields"),
+		    config.getBool("snapshot_drop_ghosts",true),
+		    config.getBool("snapshot_shared_geometry",true)));
+  const bool binary_diagnostics = config.getBool("binary_diagnostics",false);
+  WriteCycle* write_cycle = new WriteCycle("cycle.txt", binary_diagnostics);
+  FilteredConserved* filtered_conserved =
+    new FilteredConserved("total_conserved.txt", binary_diagnostics);
+  const vector<double> profile_radii =
+    parse_radii(config.getList("radial_profile_radii"));
+  RadialProfiles* radial_profiles = new RadialProfiles
+    (profile_radii.empty() ? sample_radii : profile_radii,
+     config.getDouble("radial_profile_interval",snapshot_interval),
+     eos_cache,
+     "radial_profiles.txt",
+     binary_diagnostics);
   vector<DiagnosticFunction*> diag_list = VectorInitialiser<DiagnosticFunction*>()
-    [new ConsecutiveSnapshots
-     (new ConstantTimeInterval(tf/1000),
-      new Rubric("snapshot_",".h5"),
-      VectorInitialiser<DiagnosticAppendix*>
-      (new TemperatureAppendix(eos))
-      (new EnergyAppendix(eos))
-      (new VolumeAppendix())())]
-    [new WriteTime("time.txt")]
-    [new WriteCycle("cycle.txt")]
-    [new FilteredConserved("total_conserved.txt")]
+    [snapshots]
+    [write_cycle]
+    [filtered_conserved]
+    [radial_profiles]
     ();
   MultipleDiagnostics diag(diag_list);
+  ProfileReport profiled_diag(diag, prof, eos_cache.getEOS(), "profile.csv");
+  NuclearBurn* burn = new NuclearBurn(network,
+				      string("ghost"),
+				      eos_cache,
+				      string("burn_energy_history.txt"),
+				      string("burn_cost_histogram.txt"),
+				      prof);
   MultipleManipulation manip
     (VectorInitialiser<Manipulate*>
-     (new AtlasSupport())
-     (new NuclearBurn(string("alpha_table"),
-		      string("ghost"),
-		      eos,
-		      string("burn_energy_history.txt")))
+     (new AtlasSupport(prof))
+     (burn)
+     (new HaloExchange(decomposition, eos_cache, prof))
      ());
-    main_loop(sim,
-	    term_cond,
-	    &hdsim::TimeAdvance,
-	    &diag,
-	    &manip);
-  write_snapshot_to_hdf5(sim,"final.h5",
-			 vector<DiagnosticAppendix*>
-			 (1,new TemperatureAppendix(eos)));
+  // The snapshots go first, so the writer thread is idle while the
+  // checkpoint is written through the same hdf5 library
+  const vector<CheckpointState*> states =
+    VectorInitialiser<CheckpointState*>
+    (snapshots)
+    (write_cycle)
+    (filtered_conserved)
+    (radial_profiles)
+    (&profiled_diag)
+    (burn)
+    (&eos_cache)
+    ();
+  if(!restart_file.empty()){
+    for(size_t i=0;i<states.size();++i){
+      states[i]->loadState(state);
+      states[i]->loadArrays(arrays);
+    }
+  }
+  const int rebuild_every = config.getInt("static_mesh_rebuild_every",0);
+  CheckpointTermination checkpointed_term_cond
+    (term_cond,
+     config.getString("checkpoint_file","checkpoint.h5"),
+     config.getDouble("checkpoint_interval",3600),
+     states);
+  config.checkUnused();
+  config.write("config_used.txt");
+  install_termination_handler();
+  // The order of main_loop, which only takes members of hdsim as the
+  // time step
+  while(checkpointed_term_cond(sim)){
+    if(rebuild_every>0 && sim.getCycle()>0 && sim.getCycle()%rebuild_every==0)
+      advance.requestRebuild();
+    advance(sim);
+    profiled_diag(sim);
+    manip(sim);
+  }
+  snapshots->drain();
+  // An interrupted run continues from the checkpoint, which writes final.h5
+  if(!checkpointed_term_cond.interrupted())
+    write_snapshot_to_hdf5(sim,"final.h5",
+			   vector<DiagnosticAppendix*>
+			   (1,new TemperatureAppendix(eos_cache)));
 }
@@ -2,8 +2,30 @@
 #define MY_MAIN_LOOP_HPP 1
 
 #include "source/newtonian/two_dimensional/hdsim2d.hpp"
-#include "fermi_table.hpp"
+#include "eos_cache.hpp"
+#include "phase_profiler.hpp"
+#include "config.hpp"
+#include "reaction_network.hpp"
+#include "angular_decomposition.hpp"
+#include "static_mesh_advance.hpp"
 
-void my_main_loop(hdsim& sim, const FermiTable& eos);
+/*! \brief Runs the simulation
+  \param sim Simulation
+  \param advance Time step of the simulation. The mesh is rebuilt every static_mesh_rebuild_every cycles, or never if zero
+  \param eos_cache Equation of state, with the per cell results
+  \param network Reaction network
+  \param prof Profiler
+  \param decomposition Cells of this rank, and how they are shared with the others
+  \param sample_radii Radii of the enclosed mass profile, the default bins of the radial profiles
+  \param config Run parameters. Every key is read before the first cycle, and unknown keys are rejected
+ */
+void my_main_loop(hdsim& sim,
+		  StaticMeshAdvance& advance,
+		  EosCache& eos_cache,
+		  const ReactionNetwork& network,
+		  PhaseProfiler& prof,
+		  const AngularDecomposition& decomposition,
+		  const vector<double>& sample_radii,
+		  const Config& config);
 
 #endif // MY_MAIN_LOOP_HPP
@@ -9,8 +9,8 @@ subroutine net_step (rho,tmp,x,a,z,dedtmp,matters,dtime,qreac,delx,key_done)
   dimension y(matters),yn(matters),y0(matters),y00(matters)
   dimension dy(matters),dydt(matters),dyidyj(matters,matters+1)
   dimension dx(matters)
-  data xneg/-1.d-3/
 ! -----------------------------------------------------------------
+  xneg=-1.d-3
   qreac=0.d0
   t9=min(tmp/1.d9,20.d0)
   if(t9.lt.0.05) then
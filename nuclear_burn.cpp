@@ -1,75 +1,18 @@
+#include <algorithm>
+#include <sstream>
 #include "nuclear_burn.hpp"
-#include "source/misc/vector_initialiser.hpp"
 #include "safe_retrieve.hpp"
-#include <fstream>
-
-extern "C" {
-
-  void initnet_(const char* rfile);
-
-  void burn_step_(int* indexeos,
-		  double* density,
-		  double* energy,
-		  double* tburn,
-		  double* xn,
-		  double* atomw,
-		  double* atomn,
-		  double* dedtmp,
-		  int* matters,
-		  double* dt,
-		  double* qrec,
-		  int* nse,
-		  double* tmp_nse,
-		  int* key_done,
-		  char* screen_type);
-}
+#include "angular_decomposition.hpp"
+#include "burn_step_wrapper.hpp"
+#include "wall_clock.hpp"
+#include "cell_extensive.hpp"
+#include "source/misc/vector_initialiser.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace {
 
-  pair<double,vector<double> > burn_step_wrapper(double density,
-						 double energy,
-						 double tburn,
-						 vector<double> xn,
-						 pair<double,double> az,
-						 double dt)
-  {
-    int indexeos = 0;
-    double dedtmp = 0;
-    int matters = static_cast<int>(xn.size());
-    double qrec = 0;
-    int nse = 0;
-    double tmp_nse = 1e10;
-    char screen_type[80] = "default";
-    int key_done = 0;
-    burn_step_(&indexeos,
-	       &density,
-	       &energy,
-	       &tburn,
-	       &xn[0],
-	       &az.first,
-	       &az.second,
-	       &dedtmp,
-	       &matters,
-	       &dt,
-	       &qrec,
-	       &nse,
-	       &tmp_nse,
-	       &key_done,
-	       screen_type);
-    if(key_done!=1){
-      std::ofstream f("burn_step_error_report.txt");
-      f << "density = " << density << "\n";
-      f << "energy = " << energy << "\n";
-      f << "temperature = " << tburn << "\n";
-      f << "atomic weight = " << az.first << "\n";
-      f << "atomic number = " << az.second << "\n";
-      f << "dt = " << dt << "\n";
-      f.close();
-      assert(key_done==1);
-    }
-    return pair<double,vector<double> >(qrec,xn);
-  }
-
   vector<double> serialize_tracers
   (const boost::container::flat_map<string,double>& tracers,
    const vector<string>& isotope_list)
@@ -92,72 +35,208 @@ namespace {
       res[isotope_list[i]] = compositions[i];
     return res;
   }
+
+  // Costs are binned by decade, from under a microsecond to over 0.1 s
+  const size_t cost_bins = 7;
+
+  size_t cost_bin(double cost)
+  {
+    size_t res = 0;
+    double edge = 1e-6;
+    while(res+1<cost_bins && cost>=edge){
+      ++res;
+      edge *= 10;
+    }
+    return res;
+  }
+
+  int thread_count(void)
+  {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+  }
+
+  size_t thread_index(void)
+  {
+#ifdef _OPENMP
+    return static_cast<size_t>(omp_get_thread_num());
+#else
+    return 0;
+#endif
+  }
 }
 
+NuclearBurn::Task::Task(size_t cell_i,
+			double density_i,
+			const FermiTable::ThermodynamicVariables& before,
+			const vector<double>& composition_i,
+			const pair<double,double>& aap_i):
+  cell(cell_i),
+  density(density_i),
+  energy(before.energy),
+  temperature(before.temperature),
+  composition(composition_i),
+  aap(aap_i),
+  result(),
+  cost(0) {}
+
 NuclearBurn::NuclearBurn
-(const string& rfile,
+(const ReactionNetwork& network,
  const string& ignore_label,
- const FermiTable& eos,
- const string& ehf):
+ EosCache& eos_cache,
+ const string& ehf,
+ const string& chf,
+ PhaseProfiler& prof):
   t_prev_(0),
   ignore_label_(ignore_label),
-  eos_(eos),
-  isotope_list_(VectorInitialiser<string>("He4")
-		("C12")
-		("O16")
-		("Ne20")
-		("Mg24")
-		("Si28")
-		("S32")
-		("Ar36")
-		("Ca40")
-		("Ti44")
-		("Cr48")
-		("Fe52")
-		("Ni56")()),
-  energy_history_fname_(ehf),
-  energy_history_()
+  eos_cache_(eos_cache),
+  isotope_list_(network.getIsotopes()),
+  energy_history_(ehf),
+  cost_histogram_(chf),
+  header_written_(false),
+  tasks_(),
+  costs_(),
+  order_(),
+  prof_(prof),
+  phase_(prof.addPhase("nuclear_burn")),
+  network_phase_(prof.addPhase("burn_network")),
+  burn_counter_(prof.addCounter("burn_calls")) {}
+
+double NuclearBurn::burnTasks(double dt)
 {
-  initnet_(rfile.c_str());
+  const PhaseProfiler::ScopedTimer timer(prof_, network_phase_);
+  // Most expensive first, so the long calls do not start last. Ties keep
+  // the cell order, and cells never burnt before go at the end
+  order_.resize(tasks_.size());
+  for(size_t k=0;k<tasks_.size();++k)
+    order_[k] = pair<double,size_t>(-costs_[tasks_[k].cell], k);
+  std::sort(order_.begin(), order_.end());
+  vector<double> busy(static_cast<size_t>(thread_count()), 0);
+  const int n = static_cast<int>(order_.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for(int j=0;j<n;++j){
+    Task& task = tasks_[order_[static_cast<size_t>(j)].second];
+    const double start = wall_clock();
+    task.result = burn_step_wrapper(task.density,
+				    task.energy,
+				    task.temperature,
+				    task.composition,
+				    task.aap,
+				    dt);
+    task.cost = wall_clock() - start;
+    busy[thread_index()] += task.cost;
+  }
+  return *std::max_element(busy.begin(), busy.end());
 }
 
-void NuclearBurn::operator()(hdsim& sim)
+void NuclearBurn::writeCosts(double time, double busiest)
 {
-  const double dt = sim.getTime() - t_prev_;
-  t_prev_ = sim.getTime();
+  if(!header_written_){
+    vector<string> columns = VectorInitialiser<string>
+      ("time")
+      ("cells")
+      ("total_cost")
+      ("busiest_thread")();
+    double edge = 1e-6;
+    for(size_t i=0;i+1<cost_bins;++i){
+      std::ostringstream ss;
+      ss << "under_" << edge;
+      columns.push_back(ss.str());
+      edge *= 10;
+    }
+    std::ostringstream ss;
+    ss << "over_" << edge/10;
+    columns.push_back(ss.str());
+    cost_histogram_.writeHeader(columns);
+    header_written_ = true;
+  }
+  vector<double> counts(cost_bins, 0);
   double total = 0;
+  for(size_t k=0;k<tasks_.size();++k){
+    counts[cost_bin(tasks_[k].cost)] += 1;
+    total += tasks_[k].cost;
+  }
+  vector<double> row = VectorInitialiser<double>
+    (time)
+    (static_cast<double>(tasks_.size()))
+    (total)
+    (busiest)();
+  row.insert(row.end(), counts.begin(), counts.end());
+  cost_histogram_.writeRow(row);
+}
+
+void NuclearBurn::operator()(hdsim& sim)
+{
   vector<ComputationalCell>& cells = sim.getAllCells();
+  burn(cells, sim.getTime());
+  // Only the burnt cells changed, and their new states are in the cache
+  const CacheData& cd = sim.getCacheData();
+  vector<Extensive>& extensives = sim.getAllExtensives();
+  for(size_t k=0;k<tasks_.size();++k){
+    const size_t i = tasks_[k].cell;
+    const ComputationalCell& cell = cells[i];
+    extensives[i] = cell_extensive
+      (cell,
+       cd.volumes[i],
+       eos_cache_.dp2state(i, cell.density, cell.pressure, cell.tracers).energy);
+  }
+}
+
+void NuclearBurn::burn(vector<ComputationalCell>& cells, double time)
+{
+  const PhaseProfiler::ScopedTimer timer(prof_, phase_);
+  const double dt = time - t_prev_;
+  t_prev_ = time;
+  costs_.resize(cells.size(), 0);
+  tasks_.clear();
   for(size_t i=0;i<cells.size();++i){
-    ComputationalCell& cell = cells[i];
-    if(safe_retrieve(cell.stickers,ignore_label_))
+    const ComputationalCell& cell = cells[i];
+    if(safe_retrieve(cell.stickers,ignore_label_) || is_halo(cell))
       continue;
-    const double temperature = eos_.dp2t(cell.density,
-					 cell.pressure,
-					 cell.tracers);
-    const double energy = eos_.dp2e(cell.density,
-				    cell.pressure,
-				    cell.tracers);
-    const pair<double,vector<double> > qrec_tracers =
-      burn_step_wrapper(cell.density,energy,temperature,
-			serialize_tracers(cell.tracers,
-					  isotope_list_),
-			eos_.calcAverageAtomicProperties(cell.tracers),
-			dt);
-    total += dt*qrec_tracers.first;
-    const double new_energy = energy + dt*qrec_tracers.first;
-    cell.tracers = reassemble_tracers(qrec_tracers.second,isotope_list_);
-    cell.pressure = eos_.de2p(cell.density, new_energy, cell.tracers);
+    tasks_.push_back
+      (Task(i,
+	    cell.density,
+	    eos_cache_.dp2state(i, cell.density, cell.pressure, cell.tracers),
+	    serialize_tracers(cell.tracers, isotope_list_),
+	    eos_cache_.getEOS().calcAverageAtomicProperties(cell.tracers)));
   }
-  sim.recalculateExtensives();
-  energy_history_.push_back
-    (pair<double,double>(sim.getTime(),total));
+  const double busiest = burnTasks(dt);
+  // Summed in cell order, so the total does not depend on the schedule
+  double total = 0;
+  for(size_t k=0;k<tasks_.size();++k){
+    const Task& task = tasks_[k];
+    ComputationalCell& cell = cells[task.cell];
+    prof_.count(burn_counter_);
+    costs_[task.cell] = task.cost;
+    total += dt*task.result.first;
+    const double new_energy = task.energy + dt*task.result.first;
+    cell.tracers = reassemble_tracers(task.result.second,isotope_list_);
+    const FermiTable::ThermodynamicVariables after =
+      eos_cache_.de2state(task.cell, cell.density, new_energy, cell.tracers);
+    cell.pressure = after.pressure;
+  }
+  energy_history_.writeRow(VectorInitialiser<double>
+			   (time)
+			   (total)());
+  writeCosts(time, busiest);
+}
+
+void NuclearBurn::saveState(map<string,double>& state)
+{
+  state["nuclear_burn t_prev"] = t_prev_;
+  energy_history_.saveState(state);
+  cost_histogram_.saveState(state);
 }
 
-NuclearBurn::~NuclearBurn(void)
+void NuclearBurn::loadState(const map<string,double>& state)
 {
-  std::ofstream f(energy_history_fname_.c_str());
-  for(size_t i=0;i<energy_history_.size();++i)
-    f << energy_history_[i].first << " "
-      << energy_history_[i].second << std::endl;
-  f.close();
+  t_prev_ = safe_retrieve(state,string("nuclear_burn t_prev"));
+  energy_history_.loadState(state);
+  cost_histogram_.loadState(state);
+  header_written_ = cost_histogram_.getOffset()>0;
 }
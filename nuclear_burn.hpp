@@ -4,32 +4,104 @@
 #include <map>
 #include <string>
 #include "source/newtonian/test_2d/main_loop_2d.hpp"
-#include "fermi_table.hpp"
+#include "eos_cache.hpp"
+#include "phase_profiler.hpp"
+#include "diagnostics_sink.hpp"
+#include "reaction_network.hpp"
 
 using std::map;
 using std::string;
 using std::pair;
 
-class NuclearBurn: public Manipulate
+/*! \brief Advances the composition of every live cell
+  \details The burn runs in three passes. The equation of state calls go
+  through the cache, which is not shared between threads, so the states
+  before and after the network are computed serially. The network calls in
+  between are independent, and are shared between OpenMP threads on
+  demand, most expensive first. The cost of a cell is the wall clock time
+  of its last network call, which ranges from microseconds for cold cells
+  to milliseconds near runaway. A histogram of the costs is written every
+  burn.
+ */
+class NuclearBurn: public Manipulate, public CheckpointState
 {
 public:
-  NuclearBurn(const string& rfile,
+
+  /*! \brief Class constructor
+    \param network Reaction network
+    \param ignore_label Sticker of cells that do not burn
+    \param eos_cache Equation of state, with the per cell results
+    \param ehf Name of the energy history file
+    \param chf Name of the cost histogram file
+    \param prof Profiler
+   */
+  NuclearBurn(const ReactionNetwork& network,
 	      const string& ignore_label,
-	      const FermiTable& eos,
-	      const string& ehf);
+	      EosCache& eos_cache,
+	      const string& ehf,
+	      const string& chf,
+	      PhaseProfiler& prof);
 
   void operator()(hdsim& sim);
 
-  ~NuclearBurn(void);
-  
+  /*! \brief Burns cells that are not part of an hdsim, such as the spherical runs
+    \details The caller recalculates its conserved variables afterwards
+    \param cells Cells, indexed the same in every call
+    \param time Current time. Cells burn for the time since the previous call
+   */
+  void burn(vector<ComputationalCell>& cells, double time);
+
+  void saveState(map<string,double>& state);
+
+  void loadState(const map<string,double>& state);
+
 private:
 
+  //! \brief Network call of one cell
+  class Task
+  {
+  public:
+
+    Task(size_t cell_i,
+	 double density_i,
+	 const FermiTable::ThermodynamicVariables& before,
+	 const vector<double>& composition_i,
+	 const pair<double,double>& aap_i);
+
+    size_t cell;
+    double density;
+    double energy;
+    double temperature;
+    vector<double> composition;
+    pair<double,double> aap;
+
+    //! \brief Energy release rate and new composition
+    pair<double,vector<double> > result;
+
+    //! \brief Wall clock seconds of the network call
+    double cost;
+  };
+
+  //! \brief Runs the network calls of all tasks, returns the busiest thread's time
+  double burnTasks(double dt);
+
+  void writeCosts(double time, double busiest);
+
   mutable double t_prev_;
   const string ignore_label_;
-  const FermiTable& eos_;
+  EosCache& eos_cache_;
   const vector<string> isotope_list_;
-  const string energy_history_fname_;
-  mutable vector<pair<double, double> > energy_history_;
+  DiagnosticsSink energy_history_;
+  DiagnosticsSink cost_histogram_;
+  bool header_written_;
+  vector<Task> tasks_;
+  //! \brief Cost of the last network call of each cell
+  vector<double> costs_;
+  vector<pair<double,size_t> > order_;
+  PhaseProfiler& prof_;
+  const size_t phase_;
+  const size_t network_phase_;
+  const size_t burn_counter_;
 };
 
 #endif // NUCLEAR_BURN_HPP
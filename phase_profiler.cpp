@@ -0,0 +1,113 @@
+#include <cassert>
+#include "phase_profiler.hpp"
+#include "wall_clock.hpp"
+
+PhaseProfiler::PhaseProfiler(void):
+  phase_names_(),
+  cycle_times_(),
+  total_times_(),
+  cycle_calls_(),
+  total_calls_(),
+  counter_names_(),
+  cycle_counts_(),
+  total_counts_() {}
+
+size_t PhaseProfiler::addPhase(const string& name)
+{
+  for(size_t i=0;i<phase_names_.size();++i){
+    if(phase_names_[i]==name)
+      return i;
+  }
+  phase_names_.push_back(name);
+  cycle_times_.push_back(0);
+  total_times_.push_back(0);
+  cycle_calls_.push_back(0);
+  total_calls_.push_back(0);
+  return phase_names_.size()-1;
+}
+
+size_t PhaseProfiler::addCounter(const string& name)
+{
+  for(size_t i=0;i<counter_names_.size();++i){
+    if(counter_names_[i]==name)
+      return i;
+  }
+  counter_names_.push_back(name);
+  cycle_counts_.push_back(0);
+  total_counts_.push_back(0);
+  return counter_names_.size()-1;
+}
+
+void PhaseProfiler::addTime(size_t phase, double elapsed)
+{
+  assert(phase<phase_names_.size());
+  cycle_times_[phase] += elapsed;
+  total_times_[phase] += elapsed;
+  ++cycle_calls_[phase];
+  ++total_calls_[phase];
+}
+
+void PhaseProfiler::count(size_t counter, size_t n)
+{
+  assert(counter<counter_names_.size());
+  cycle_counts_[counter] += n;
+  total_counts_[counter] += n;
+}
+
+void PhaseProfiler::endCycle(void)
+{
+  for(size_t i=0;i<cycle_times_.size();++i){
+    cycle_times_[i] = 0;
+    cycle_calls_[i] = 0;
+  }
+  for(size_t i=0;i<cycle_counts_.size();++i)
+    cycle_counts_[i] = 0;
+}
+
+const vector<string>& PhaseProfiler::getPhaseNames(void) const
+{
+  return phase_names_;
+}
+
+const vector<double>& PhaseProfiler::getCycleTimes(void) const
+{
+  return cycle_times_;
+}
+
+const vector<double>& PhaseProfiler::getTotalTimes(void) const
+{
+  return total_times_;
+}
+
+const vector<size_t>& PhaseProfiler::getCycleCalls(void) const
+{
+  return cycle_calls_;
+}
+
+const vector<size_t>& PhaseProfiler::getTotalCalls(void) const
+{
+  return total_calls_;
+}
+
+const vector<string>& PhaseProfiler::getCounterNames(void) const
+{
+  return counter_names_;
+}
+
+const vector<size_t>& PhaseProfiler::getCycleCounts(void) const
+{
+  return cycle_counts_;
+}
+
+const vector<size_t>& PhaseProfiler::getTotalCounts(void) const
+{
+  return total_counts_;
+}
+
+PhaseProfiler::ScopedTimer::ScopedTimer(PhaseProfiler& prof, size_t phase):
+  prof_(prof), phase_(phase), start_(wall_clock()) {}
+
+PhaseProfiler::ScopedTimer::~ScopedTimer(void)
+{
+  prof_.addTime(phase_, wall_clock()-start_);
+}
@@ -0,0 +1,83 @@
+#ifndef PHASE_PROFILER_HPP
+#define PHASE_PROFILER_HPP 1
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+using std::vector;
+using std::string;
+using std::size_t;
+
+//! \brief Accumulates wall clock time and event counts per named phase
+class PhaseProfiler
+{
+public:
+
+  PhaseProfiler(void);
+
+  /*! \brief Registers a timed phase
+    \param name Phase name
+    \return Handle used by the timers
+   */
+  size_t addPhase(const string& name);
+
+  /*! \brief Registers an event counter
+    \param name Counter name
+    \return Handle used by count
+   */
+  size_t addCounter(const string& name);
+
+  void addTime(size_t phase, double elapsed);
+
+  void count(size_t counter, size_t n=1);
+
+  //! \brief Clears the per cycle accumulators
+  void endCycle(void);
+
+  const vector<string>& getPhaseNames(void) const;
+
+  const vector<double>& getCycleTimes(void) const;
+
+  const vector<double>& getTotalTimes(void) const;
+
+  const vector<size_t>& getCycleCalls(void) const;
+
+  const vector<size_t>& getTotalCalls(void) const;
+
+  const vector<string>& getCounterNames(void) const;
+
+  const vector<size_t>& getCycleCounts(void) const;
+
+  const vector<size_t>& getTotalCounts(void) const;
+
+  //! \brief Adds the time spent in its scope to a phase
+  class ScopedTimer
+  {
+  public:
+
+    ScopedTimer(PhaseProfiler& prof, size_t phase);
+
+    ~ScopedTimer(void);
+
+  private:
+    PhaseProfiler& prof_;
+    const size_t phase_;
+    const double start_;
+
+    ScopedTimer(const ScopedTimer&);
+    ScopedTimer& operator=(const ScopedTimer&);
+  };
+
+private:
+  vector<string> phase_names_;
+  vector<double> cycle_times_;
+  vector<double> total_times_;
+  vector<size_t> cycle_calls_;
+  vector<size_t> total_calls_;
+  vector<string> counter_names_;
+  vector<size_t> cycle_counts_;
+  vector<size_t> total_counts_;
+};
+
+#endif // PHASE_PROFILER_HPP
@@ -0,0 +1,119 @@
+#include "profile_report.hpp"
+#include "wall_clock.hpp"
+#include "safe_retrieve.hpp"
+
+ProfileReport::ProfileReport(DiagnosticFunction& diag,
+			     PhaseProfiler& prof,
+			     const FermiTable& eos,
+			     const string& fname):
+  diag_(diag),
+  prof_(prof),
+  eos_(eos),
+  diag_phase_(prof.addPhase("diagnostics")),
+  eos_counter_(prof.addCounter("eos_calls")),
+  eos_calls_prev_(eos.getCallCount()),
+  inversion_counter_(prof.addCounter("eos_inversions")),
+  inversions_prev_(eos.getInversionCount()),
+  iteration_counter_(prof.addCounter("eos_inversion_iterations")),
+  iterations_prev_(eos.getInversionIterations()),
+  wall_prev_(wall_clock()),
+  wall_total_(0),
+  other_total_(0),
+  sink_(fname, false, ','),
+  header_written_(false),
+  columns_(0) {}
+
+void ProfileReport::writeHeader(void)
+{
+  vector<string> columns;
+  columns.push_back("cycle");
+  columns.push_back("time");
+  columns.push_back("wall");
+  columns.push_back("wall_total");
+  columns.push_back("other");
+  columns.push_back("other_total");
+  const vector<string>& phases = prof_.getPhaseNames();
+  for(size_t i=0;i<phases.size();++i){
+    columns.push_back(phases[i]);
+    columns.push_back(phases[i]+"_total");
+    columns.push_back(phases[i]+"_calls");
+  }
+  const vector<string>& counters = prof_.getCounterNames();
+  for(size_t i=0;i<counters.size();++i){
+    columns.push_back(counters[i]);
+    columns.push_back(counters[i]+"_total");
+  }
+  sink_.writeHeader(columns);
+  header_written_ = true;
+}
+
+void ProfileReport::operator()(const hdsim& sim)
+{
+  {
+    const PhaseProfiler::ScopedTimer timer(prof_, diag_phase_);
+    diag_(sim);
+  }
+  const size_t eos_calls = eos_.getCallCount();
+  prof_.count(eos_counter_, eos_calls-eos_calls_prev_);
+  eos_calls_prev_ = eos_calls;
+  const size_t inversions = eos_.getInversionCount();
+  prof_.count(inversion_counter_, inversions-inversions_prev_);
+  inversions_prev_ = inversions;
+  const size_t iterations = eos_.getInversionIterations();
+  prof_.count(iteration_counter_, iterations-iterations_prev_);
+  iterations_prev_ = iterations;
+  const double now = wall_clock();
+  const double wall = now - wall_prev_;
+  wall_prev_ = now;
+  wall_total_ += wall;
+  const vector<double>& cycle_times = prof_.getCycleTimes();
+  double other = wall;
+  for(size_t i=0;i<cycle_times.size();++i)
+    other -= cycle_times[i];
+  other_total_ += other;
+
+  if(!header_written_)
+    writeHeader();
+  vector<double> row;
+  row.push_back(sim.getCycle());
+  row.push_back(sim.getTime());
+  row.push_back(wall);
+  row.push_back(wall_total_);
+  row.push_back(other);
+  row.push_back(other_total_);
+  const vector<double>& total_times = prof_.getTotalTimes();
+  const vector<size_t>& total_calls = prof_.getTotalCalls();
+  for(size_t i=0;i<cycle_times.size();++i){
+    row.push_back(cycle_times[i]);
+    row.push_back(total_times[i]);
+    row.push_back(static_cast<double>(total_calls[i]));
+  }
+  const vector<size_t>& cycle_counts = prof_.getCycleCounts();
+  const vector<size_t>& total_counts = prof_.getTotalCounts();
+  for(size_t i=0;i<cycle_counts.size();++i){
+    row.push_back(static_cast<double>(cycle_counts[i]));
+    row.push_back(static_cast<double>(total_counts[i]));
+  }
+  if(columns_==0)
+    columns_ = row.size();
+  if(row.size()!=columns_)
+    throw string("profile.csv: a phase or counter was added after the first cycle");
+  sink_.writeRow(row);
+  prof_.endCycle();
+}
+
+void ProfileReport::saveState(map<string,double>& state)
+{
+  state["profile wall_total"] = wall_total_;
+  state["profile other_total"] = other_total_;
+  sink_.saveState(state);
+}
+
+void ProfileReport::loadState(const map<string,double>& state)
+{
+  wall_total_ = safe_retrieve(state,string("profile wall_total"));
+  other_total_ = safe_retrieve(state,string("profile other_total"));
+  sink_.loadState(state);
+  header_written_ = sink_.getOffset()>0;
+  wall_prev_ = wall_clock();
+}
@@ -0,0 +1,58 @@
+#ifndef PROFILE_REPORT_HPP
+#define PROFILE_REPORT_HPP 1
+
+#include "source/newtonian/test_2d/main_loop_2d.hpp"
+#include "phase_profiler.hpp"
+#include "fermi_table.hpp"
+#include "diagnostics_sink.hpp"
+
+/*! \brief Times the diagnostics and writes one row of phase timings per cycle
+  \details The "other" column is the part of the cycle not covered by any
+  phase, which is dominated by the tessellation update inside hdsim. The
+  columns are fixed by the first row, so all phases and counters must be
+  registered before the first cycle.
+ */
+class ProfileReport: public DiagnosticFunction, public CheckpointState
+{
+public:
+
+  /*! \brief Class constructor
+    \param diag Diagnostics to time
+    \param prof Profiler shared with the timed components
+    \param eos Equation of state, for call and inversion iteration counts
+    \param fname Name of output file
+   */
+  ProfileReport(DiagnosticFunction& diag,
+		PhaseProfiler& prof,
+		const FermiTable& eos,
+		const string& fname);
+
+  void operator()(const hdsim& sim);
+
+  void saveState(map<string,double>& state);
+
+  void loadState(const map<string,double>& state);
+
+private:
+  DiagnosticFunction& diag_;
+  PhaseProfiler& prof_;
+  const FermiTable& eos_;
+  const size_t diag_phase_;
+  const size_t eos_counter_;
+  size_t eos_calls_prev_;
+  const size_t inversion_counter_;
+  size_t inversions_prev_;
+  const size_t iteration_counter_;
+  size_t iterations_prev_;
+  double wall_prev_;
+  double wall_total_;
+  double other_total_;
+  DiagnosticsSink sink_;
+  bool header_written_;
+  //! \brief Length of the first row, zero before it is written
+  size_t columns_;
+
+  void writeHeader(void);
+};
+
+#endif // PROFILE_REPORT_HPP
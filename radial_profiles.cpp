@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <limits>
+#include "radial_profiles.hpp"
+#include "safe_retrieve.hpp"
+#include "angular_decomposition.hpp"
+#include "mpi_support.hpp"
+
+namespace {
+  // Density, pressure, radial velocity and temperature, then the tracers
+  const size_t fixed_quantities = 4;
+
+  void collect(const ComputationalCell& cell,
+	       const Vector2D& r,
+	       double temperature,
+	       vector<double>& res)
+  {
+    res.clear();
+    res.push_back(cell.density);
+    res.push_back(cell.pressure);
+    res.push_back(ScalarProd(cell.velocity, r)/abs(r));
+    res.push_back(temperature);
+    for(boost::container::flat_map<string,double>::const_iterator it =
+	  cell.tracers.begin();
+	it!=cell.tracers.end();
+	++it)
+      res.push_back(it->second);
+  }
+}
+
+RadialProfiles::RadialProfiles(const vector<double>& radii,
+			       double interval,
+			       EosCache& eos_cache,
+			       const string& fname,
+			       bool binary):
+  radii_(radii),
+  interval_(interval),
+  eos_cache_(eos_cache),
+  written_(0),
+  sink_(fname, binary),
+  header_written_(false)
+{
+  if(radii.size()<2)
+    throw "RadialProfiles: need at least one bin";
+  if(!(interval>0))
+    throw "RadialProfiles: interval must be positive";
+}
+
+void RadialProfiles::writeHeader(const ComputationalCell& cell)
+{
+  vector<string> names;
+  names.push_back("density");
+  names.push_back("pressure");
+  names.push_back("radial_velocity");
+  names.push_back("temperature");
+  for(boost::container::flat_map<string,double>::const_iterator it =
+	cell.tracers.begin();
+      it!=cell.tracers.end();
+      ++it)
+    names.push_back(it->first);
+  vector<string> columns;
+  columns.push_back("time");
+  columns.push_back("radius_in");
+  columns.push_back("radius_out");
+  columns.push_back("mass");
+  columns.push_back("cells");
+  for(size_t i=0;i<names.size();++i){
+    columns.push_back(names[i]+"_mean");
+    columns.push_back(names[i]+"_min");
+    columns.push_back(names[i]+"_max");
+  }
+  sink_.writeHeader(columns);
+  header_written_ = true;
+}
+
+void RadialProfiles::operator()(const hdsim& sim)
+{
+  if(sim.getTime()<static_cast<double>(written_)*interval_)
+    return;
+  ++written_;
+  const vector<ComputationalCell>& cells = sim.getAllCells();
+  const Tessellation& tess = sim.getTessellation();
+  const CacheData& cd = sim.getCacheData();
+  const size_t n_bins = radii_.size()-1;
+  const size_t n_quantities =
+    fixed_quantities + cells.front().tracers.size();
+  // Per bin: mass, cells, then the mass weighted sum of each quantity
+  const size_t stride = 2+n_quantities;
+  vector<double> sums(n_bins*stride, 0);
+  // Maxima are kept negated, so one reduction takes both
+  vector<double> extremes(2*n_bins*n_quantities,
+			  std::numeric_limits<double>::max());
+  vector<double> values;
+  for(size_t i=0;i<cells.size();++i){
+    const ComputationalCell& cell = cells[i];
+    if(safe_retrieve(cell.stickers,string("ghost")) || is_halo(cell))
+      continue;
+    const Vector2D r = tess.GetCellCM(static_cast<int>(i));
+    const double radius = abs(r);
+    if(radius<radii_.front() || radius>=radii_.back())
+      continue;
+    const size_t bin = static_cast<size_t>
+      (std::upper_bound(radii_.begin(), radii_.end(), radius) -
+       radii_.begin()) - 1;
+    const double mass = cd.volumes[i]*cell.density;
+    collect(cell,
+	    r,
+	    eos_cache_.dp2state(i, cell.density, cell.pressure,
+				cell.tracers).temperature,
+	    values);
+    double* sum = &sums[bin*stride];
+    sum[0] += mass;
+    sum[1] += 1;
+    double* extreme = &extremes[2*bin*n_quantities];
+    for(size_t k=0;k<n_quantities;++k){
+      sum[2+k] += mass*values[k];
+      extreme[2*k] = std::min(extreme[2*k], values[k]);
+      extreme[2*k+1] = std::min(extreme[2*k+1], -values[k]);
+    }
+  }
+  sums = global_sum(sums);
+  extremes = global_min(extremes);
+  if(mpi_rank()!=0)
+    return;
+  if(!header_written_)
+    writeHeader(cells.front());
+  for(size_t b=0;b<n_bins;++b){
+    const double* sum = &sums[b*stride];
+    const double* extreme = &extremes[2*b*n_quantities];
+    const bool empty = !(sum[1]>0);
+    vector<double> row;
+    row.push_back(sim.getTime());
+    row.push_back(radii_[b]);
+    row.push_back(radii_[b+1]);
+    row.push_back(sum[0]);
+    row.push_back(sum[1]);
+    for(size_t k=0;k<n_quantities;++k){
+      row.push_back(empty ? 0 : sum[2+k]/sum[0]);
+      row.push_back(empty ? 0 : extreme[2*k]);
+      row.push_back(empty ? 0 : -extreme[2*k+1]);
+    }
+    sink_.writeRow(row);
+  }
+}
+
+void RadialProfiles::saveState(map<string,double>& state)
+{
+  state["radial_profiles written"] = static_cast<double>(written_);
+  sink_.saveState(state);
+}
+
+void RadialProfiles::loadState(const map<string,double>& state)
+{
+  written_ = static_cast<size_t>
+    (safe_retrieve(state,string("radial_profiles written")));
+  sink_.loadState(state);
+  header_written_ = sink_.getOffset()>0;
+}
@@ -0,0 +1,57 @@
+#ifndef RADIAL_PROFILES_HPP
+#define RADIAL_PROFILES_HPP 1
+
+#include <string>
+#include <vector>
+#include "source/newtonian/test_2d/main_loop_2d.hpp"
+#include "diagnostics_sink.hpp"
+#include "eos_cache.hpp"
+
+using std::string;
+using std::vector;
+
+/*! \brief Radial profiles of the live cells, written at a fixed interval
+  \details Cells are binned by the radius of their centre of mass. Each bin
+  gets one row per output: time, inner and outer radius, mass, number of
+  cells, then the mass weighted mean, minimum and maximum of density,
+  pressure, radial velocity, temperature and every tracer. The temperature
+  comes from the equation of state cache. Empty bins are written with
+  zeros. In runs divided between MPI ranks the bins
+  are reduced over all ranks, and rank 0 writes them.
+ */
+class RadialProfiles: public DiagnosticFunction, public CheckpointState
+{
+public:
+
+  /*! \brief Class constructor
+    \param radii Bin edges, increasing
+    \param interval Simulation time between outputs
+    \param eos_cache Equation of state cache, for the temperature
+    \param fname Name of output file
+    \param binary Write raw doubles instead of text
+   */
+  RadialProfiles(const vector<double>& radii,
+		 double interval,
+		 EosCache& eos_cache,
+		 const string& fname,
+		 bool binary=false);
+
+  void operator()(const hdsim& sim);
+
+  void saveState(map<string,double>& state);
+
+  void loadState(const map<string,double>& state);
+
+private:
+
+  void writeHeader(const ComputationalCell& cell);
+
+  const vector<double> radii_;
+  const double interval_;
+  EosCache& eos_cache_;
+  size_t written_;
+  DiagnosticsSink sink_;
+  bool header_written_;
+};
+
+#endif // RADIAL_PROFILES_HPP
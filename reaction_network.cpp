@@ -0,0 +1,35 @@
+#include <cassert>
+#include "reaction_network.hpp"
+#include "burn_step_wrapper.hpp"
+#include "wall_clock.hpp"
+
+namespace {
+  bool network_loaded = false;
+}
+
+ReactionNetwork::ReactionNetwork(const string& fname):
+  fname_(fname),
+  isotopes_(network_isotopes()),
+  load_time_(0)
+{
+  assert(!network_loaded);
+  const double begin = wall_clock();
+  init_network(fname);
+  load_time_ = wall_clock() - begin;
+  network_loaded = true;
+}
+
+const string& ReactionNetwork::getFileName(void) const
+{
+  return fname_;
+}
+
+const vector<string>& ReactionNetwork::getIsotopes(void) const
+{
+  return isotopes_;
+}
+
+double ReactionNetwork::getLoadTime(void) const
+{
+  return load_time_;
+}
@@ -0,0 +1,40 @@
+#ifndef REACTION_NETWORK_HPP
+#define REACTION_NETWORK_HPP 1
+
+#include <vector>
+#include <string>
+
+using std::vector;
+using std::string;
+
+/*! \brief Reaction network, loaded into the Fortran common blocks
+  \details Like the equation of state tables, the network is global Fortran
+  state, so there can only be one instance per process.
+ */
+class ReactionNetwork
+{
+public:
+
+  /*! \brief Loads the network
+    \param fname Name of reaction rate table
+   */
+  explicit ReactionNetwork(const string& fname);
+
+  const string& getFileName(void) const;
+
+  //! \brief Isotope names in network order
+  const vector<string>& getIsotopes(void) const;
+
+  //! \brief Wall clock seconds spent loading
+  double getLoadTime(void) const;
+
+private:
+  const string fname_;
+  const vector<string> isotopes_;
+  double load_time_;
+
+  ReactionNetwork(const ReactionNetwork&);
+  ReactionNetwork& operator=(const ReactionNetwork&);
+};
+
+#endif // REACTION_NETWORK_HPP
@@ -0,0 +1,18 @@
+#include <cassert>
+#include "refinement_band.hpp"
+
+RefinementBand::RefinementBand(double radius_in_i,
+			       double radius_out_i,
+			       double factor_i):
+  radius_in(radius_in_i),
+  radius_out(radius_out_i),
+  factor(factor_i)
+{
+  assert(radius_in<radius_out);
+  assert(factor>=1);
+}
+
+bool RefinementBand::contains(double radius) const
+{
+  return radius_in<=radius && radius<radius_out;
+}
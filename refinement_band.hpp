@@ -0,0 +1,29 @@
+#ifndef REFINEMENT_BAND_HPP
+#define REFINEMENT_BAND_HPP 1
+
+//! \brief Radial range where the mesh spacing is divided by a constant factor
+class RefinementBand
+{
+public:
+
+  /*! \brief Class constructor
+    \param radius_in_i Inner radius
+    \param radius_out_i Outer radius
+    \param factor_i Refinement factor, larger than one
+   */
+  RefinementBand(double radius_in_i,
+		 double radius_out_i,
+		 double factor_i);
+
+  /*! \brief Checks whether a radius is inside the band
+    \param radius Radius
+    \return True if inside
+   */
+  bool contains(double radius) const;
+
+  double radius_in;
+  double radius_out;
+  double factor;
+};
+
+#endif // REFINEMENT_BAND_HPP
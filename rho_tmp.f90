@@ -15,6 +15,7 @@ subroutine rho_tmp
   dimension ix(4),jx(4)
   dimension sp(6),dsp(6),tp(6),dtp(6)
 ! -------------------------------------------------------
+  rho_tmp_calls=rho_tmp_calls+1
   entropy_const=2.5d0+1.5d0*log(2*pi/avogadro)-log(avogadro) &
        -3*log(planck)
   coulomb=coul*pai43**third*avogadro**f43
@@ -1,35 +1,88 @@
-#include <ctime>
-#include "units.hpp"
+#include <iostream>
+#include "run_simulation.hpp"
+#include "batch_runner.hpp"
 #include "sim_data.hpp"
-#include "my_main_loop.hpp"
+#include "mpi_support.hpp"
+#include "launch_directory.hpp"
 #include <fenv.h>
+#include <cerrno>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef WITH_MPI
+#include <mpi.h>
+#endif
 
 using namespace std;
 
-int main(void)
-{
-  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+namespace {
+  //! \brief Gives every rank of a divided run its own output directory
+  void enter_rank_directory(void)
+  {
+    std::ostringstream ss;
+    ss << "rank_" << mpi_rank();
+    const string directory = ss.str();
+    if(mkdir(directory.c_str(),0755)!=0 && errno!=EEXIST)
+      throw "failed to create " + directory;
+    if(chdir(directory.c_str())!=0)
+      throw "failed to enter " + directory;
+  }
 
-  const clock_t begin = clock();
-  const Units units;
-  const InitialData id
-    ("radius_list.txt",
-     "density_list.txt",
-     "temperature_list.txt",
-     "velocity_list.txt");
-  SimData sim_data(id,
-		   units,
-		   CircularSection(id.radius_mid.front(),
-				   id.radius_mid.back(),
-				   0.49*M_PI,
-				   0.51*M_PI));
-  hdsim& sim = sim_data.getSim();
-  my_main_loop(sim,sim_data.getEOS());
+  int run(int argc, char** argv)
+  {
+    // Recorded before the batch and rank directories are entered
+    launch_directory();
+    // Parameters come from config=<file> and key=value arguments
+    const Config config(argc, argv);
+    const EosTables tables(config.getString("eos_table","eos_tab.coded"));
+    const ReactionNetwork network(config.getString("burn_table",
+						   "alpha_table"));
+    const InitialData id = load_initial_data(config);
+    cout << "eos table read in " << tables.getReadTime()
+	 << " s, parsed in " << tables.getParseTime() << " s" << endl;
+    cout << "tables loaded in "
+	 << tables.getLoadTime() + network.getLoadTime() << " s" << endl;
+    const string batch = config.getString("batch","");
+    const size_t jobs = config.getSize("batch_jobs",1);
+    if(mpi_size()>1){
+      if(!batch.empty())
+	throw "batch runs are not divided between MPI ranks";
+      enter_rank_directory();
+    }
+    if(!batch.empty())
+      return run_batch(batch,
+		       config,
+		       jobs,
+		       tables,
+		       network,
+		       id)==0 ? 0 : 1;
+    run_simulation(config, tables, network, id);
+    return 0;
+  }
+}
 
-  const clock_t end = clock();
-  ofstream f("wall_time.txt");
-  f << static_cast<double>(end-begin)/CLOCKS_PER_SEC << endl;
-  f.close();
+int main(int argc, char** argv)
+{
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+#ifdef WITH_MPI
+  MPI_Init(&argc, &argv);
+#endif
 
-  return 0;
+  int status = 1;
+  try{
+    status = run(argc, argv);
+  }
+  catch(const string& error){
+    cerr << error << endl;
+  }
+  catch(const char* error){
+    cerr << error << endl;
+  }
+#ifdef WITH_MPI
+  // A rank that failed alone would leave the others waiting in a reduction
+  if(status!=0 && mpi_size()>1)
+    MPI_Abort(MPI_COMM_WORLD, status);
+  MPI_Finalize();
+#endif
+  return status;
 }
@@ -0,0 +1,59 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include "run_simulation.hpp"
+#include "units.hpp"
+#include "sim_data.hpp"
+#include "my_main_loop.hpp"
+#include "wall_clock.hpp"
+#include "run_spherical.hpp"
+
+void run_simulation(const Config& config,
+		    const EosTables& tables,
+		    const ReactionNetwork& network,
+		    const InitialData& id)
+{
+  const string geometry = config.getString("geometry","wedge");
+  if(geometry=="spherical"){
+    run_spherical(config, tables, network, id);
+    return;
+  }
+  if(geometry!="wedge")
+    throw "unknown geometry " + geometry;
+  const double begin = wall_clock();
+  const Units units;
+  SimData sim_data(config, tables, id, units, wedge_domain(config, id));
+  hdsim& sim = sim_data.getSim();
+  const double startup = wall_clock() - begin;
+  std::cout << "startup took " << startup << " s" << std::endl;
+  StaticMeshAdvance& advance = sim_data.getAdvance();
+  my_main_loop(sim,
+	       advance,
+	       sim_data.getEOSCache(),
+	       network,
+	       sim_data.getProfiler(),
+	       sim_data.getDecomposition(),
+	       sim_data.getGravity().getSampleRadii(),
+	       config);
+
+  std::ofstream f("wall_time.txt");
+  f << "startup " << startup << "\n";
+  f << "total " << wall_clock() - begin << "\n";
+  f << "cycles " << sim.getCycle() << "\n";
+  f << "cells " << sim.getTessellation().GetPointNo() << "\n";
+  f << "static_mesh " << (advance.isEnabled() ? 1 : 0) << "\n";
+  f << "mesh_rebuilds " << advance.getRebuilds() << "\n";
+  f << "time_advance_per_cycle "
+    << advance.getTotalTime()/
+    static_cast<double>(std::max(sim.getCycle(),1)) << "\n";
+  const FermiTable& eos = sim_data.getEOS();
+  f << "eos_inversions " << eos.getInversionCount() << "\n";
+  f << "eos_iterations_per_inversion "
+    << static_cast<double>(eos.getInversionIterations())/
+    static_cast<double>(std::max<size_t>(eos.getInversionCount(),1))
+    << "\n";
+  const EosCache& eos_cache = sim_data.getEOSCache();
+  f << "eos_cache_hits " << eos_cache.getHits() << "\n";
+  f << "eos_cache_misses " << eos_cache.getMisses() << "\n";
+  f.close();
+}
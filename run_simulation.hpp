@@ -0,0 +1,23 @@
+#ifndef RUN_SIMULATION_HPP
+#define RUN_SIMULATION_HPP 1
+
+#include "config.hpp"
+#include "eos_tables.hpp"
+#include "reaction_network.hpp"
+#include "initial_data.hpp"
+
+/*! \brief Builds and runs one simulation in the working directory
+  \details Writes wall_time.txt, with the startup and total wall clock
+  seconds, the number of cycles and the number of cells. With
+  geometry=spherical, runs the spherically symmetric model instead
+  \param config Run parameters: geometry (wedge or spherical), and those of the chosen model
+  \param tables Equation of state tables
+  \param network Reaction network
+  \param id Initial profiles
+ */
+void run_simulation(const Config& config,
+		    const EosTables& tables,
+		    const ReactionNetwork& network,
+		    const InitialData& id);
+
+#endif // RUN_SIMULATION_HPP
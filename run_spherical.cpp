@@ -0,0 +1,128 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include "run_spherical.hpp"
+#include "spherical_sim.hpp"
+#include "nuclear_burn.hpp"
+#include "units.hpp"
+#include "generate_atomic_properties.hpp"
+#include "diagnostics_sink.hpp"
+#include "mpi_support.hpp"
+#include "wall_clock.hpp"
+#include "source/misc/utils.hpp"
+
+namespace {
+  void write_profiles(const SphericalSim& sim,
+		      EosCache& eos_cache,
+		      const string& fname)
+  {
+    const vector<ComputationalCell>& cells = sim.getCells();
+    const vector<double>& radii = sim.getRadii();
+    DiagnosticsSink sink(fname);
+    vector<string> columns;
+    columns.push_back("radius");
+    columns.push_back("density");
+    columns.push_back("pressure");
+    columns.push_back("temperature");
+    columns.push_back("velocity");
+    for(boost::container::flat_map<string,double>::const_iterator it =
+	  cells.front().tracers.begin();
+	it!=cells.front().tracers.end();
+	++it)
+      columns.push_back(it->first);
+    sink.writeHeader(columns);
+    for(size_t i=0;i<cells.size();++i){
+      vector<double> row;
+      row.push_back(radii[i]);
+      row.push_back(cells[i].density);
+      row.push_back(cells[i].pressure);
+      row.push_back(eos_cache.dp2state(i,
+				       cells[i].density,
+				       cells[i].pressure,
+				       cells[i].tracers).temperature);
+      row.push_back(cells[i].velocity.x);
+      for(boost::container::flat_map<string,double>::const_iterator it =
+	    cells[i].tracers.begin();
+	  it!=cells[i].tracers.end();
+	  ++it)
+	row.push_back(it->second);
+      sink.writeRow(row);
+    }
+  }
+}
+
+void run_spherical(const Config& config,
+		   const EosTables& tables,
+		   const ReactionNetwork& network,
+		   const InitialData& id)
+{
+  if(mpi_size()>1)
+    throw "spherical runs are not divided between MPI ranks";
+  const double begin = wall_clock();
+  const Units units;
+  PhaseProfiler prof;
+  const FermiTable eos(tables,
+		       config.getInt("eos_gas",1),
+		       config.getInt("eos_photons",1),
+		       config.getInt("eos_coulomb",0),
+		       generate_atomic_properties());
+  EosCache eos_cache(eos,
+		     config.getDouble("eos_cache_tolerance",1e-10),
+		     config.getBool("eos_cache_strict",false),
+		     prof);
+  eos_cache.seedTemperatures(id.temperature_list);
+  SphericalSim sim(id.radius_list,
+		   spherical_init_cond(id, eos),
+		   eos_cache,
+		   units.core_mass,
+		   linspace(id.radius_list.front(),
+			    id.radius_list.back(),
+			    config.getInt("gravity_samples",100)),
+		   units.gravitation_constant,
+		   config.getDouble("cfl",0.3),
+		   prof);
+  NuclearBurn burn(network,
+		   string("ghost"),
+		   eos_cache,
+		   string("burn_energy_history.txt"),
+		   string("burn_cost_histogram.txt"),
+		   prof);
+  const double tf = config.getDouble("final_time",20);
+  const int max_cycles = config.getInt("max_cycles",1000000);
+  const double snapshot_interval =
+    config.getDouble("snapshot_interval",tf/1000);
+  config.checkUnused();
+  config.write("config_used.txt");
+  const double startup = wall_clock() - begin;
+  std::cout << "startup took " << startup << " s" << std::endl;
+
+  write_profiles(sim, eos_cache, "initial.txt");
+  size_t snapshots = 0;
+  while(sim.getTime()<tf && sim.getCycle()<max_cycles){
+    sim.timeAdvance();
+    burn.burn(sim.getCells(), sim.getTime());
+    sim.recalculateExtensives();
+    if(sim.getTime()>=static_cast<double>(snapshots+1)*snapshot_interval){
+      std::ostringstream fname;
+      fname << "snapshot_" << snapshots << ".txt";
+      write_profiles(sim, eos_cache, fname.str());
+      ++snapshots;
+    }
+  }
+  write_profiles(sim, eos_cache, "final.txt");
+
+  std::ofstream f("wall_time.txt");
+  f << "startup " << startup << "\n";
+  f << "total " << wall_clock() - begin << "\n";
+  f << "cycles " << sim.getCycle() << "\n";
+  f << "cells " << sim.getCells().size() << "\n";
+  f << "eos_inversions " << eos.getInversionCount() << "\n";
+  f << "eos_iterations_per_inversion "
+    << static_cast<double>(eos.getInversionIterations())/
+    static_cast<double>(std::max<size_t>(eos.getInversionCount(),1))
+    << "\n";
+  f << "eos_cache_hits " << eos_cache.getHits() << "\n";
+  f << "eos_cache_misses " << eos_cache.getMisses() << "\n";
+  f.close();
+}
@@ -0,0 +1,25 @@
+#ifndef RUN_SPHERICAL_HPP
+#define RUN_SPHERICAL_HPP 1
+
+#include "config.hpp"
+#include "eos_tables.hpp"
+#include "reaction_network.hpp"
+#include "initial_data.hpp"
+
+/*! \brief Runs a spherically symmetric simulation in the working directory
+  \details The shells are those of the radius file. The profiles go to
+  initial.txt, snapshot_<n>.txt every snapshot interval, and final.txt,
+  one row per shell. The energy history, the burn cost histogram and
+  wall_time.txt are written as in the wedge runs. There are no
+  checkpoints, and the run is not divided between MPI ranks.
+  \param config Run parameters: eos_gas, eos_photons, eos_coulomb, eos_cache_tolerance, eos_cache_strict, gravity_samples, cfl, final_time, max_cycles and snapshot_interval
+  \param tables Equation of state tables
+  \param network Reaction network
+  \param id Initial profiles
+ */
+void run_spherical(const Config& config,
+		   const EosTables& tables,
+		   const ReactionNetwork& network,
+		   const InitialData& id);
+
+#endif // RUN_SPHERICAL_HPP
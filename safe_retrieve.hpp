@@ -1,3 +1,8 @@
+#ifndef SAFE_RETRIEVE_HPP
+#define SAFE_RETRIEVE_HPP 1
+
+#include <map>
+
 template<class S, class T> const T& safe_retrieve
 (const boost::container::flat_map<S,T>& m,
  const S& s)
@@ -5,3 +10,13 @@ template<class S, class T> const T& safe_retrieve
   assert(m.find(s)!=m.end());
   return m.find(s)->second;
 }
+
+template<class S, class T> const T& safe_retrieve
+(const std::map<S,T>& m,
+ const S& s)
+{
+  assert(m.find(s)!=m.end());
+  return m.find(s)->second;
+}
+
+#endif // SAFE_RETRIEVE_HPP
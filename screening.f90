@@ -38,13 +38,8 @@
     B_f1(iz,x)=par_elec(4,iz)+par_elec(5,iz)*log(1+par_elec(6,iz)/(1+x**2))
     C_f1(iz,x)=par_elec(7,iz)+par_elec(8,iz)*log(1+par_elec(9,iz)/(1+x**2))
     f1(g,iz,xf)=0
-!
-    data init_screen/0/
 ! -----------------------------------------------------------------------------------
-    if(init_screen.eq.0) then
-      init_screen=1
-      call screen_init
-    endif
+! screen_par is filled once by initnet, before the burn runs in threads
 ! -----------------------------------------------------------------------------------
     t8=tmp/1.d8
     ro6=rho/1.d6
@@ -1,50 +1,157 @@
 #include "sim_data.hpp"
 #include "calc_bottom_area.hpp"
+#include "mpi_support.hpp"
+#include "launch_directory.hpp"
+#include <cstdio>
 
-SimData::SimData(const InitialData& id,
+namespace {
+  vector<RefinementBand> parse_bands(const vector<string>& items)
+  {
+    vector<RefinementBand> res;
+    for(size_t i=0;i<items.size();++i){
+      double radius_in = 0;
+      double radius_out = 0;
+      double factor = 0;
+      char tail = 0;
+      if(sscanf(items[i].c_str(),"%lf:%lf:%lf%c",
+		&radius_in,&radius_out,&factor,&tail)!=3)
+	throw "refinement_bands: expected r_in:r_out:factor, got " + items[i];
+      res.push_back(RefinementBand(radius_in, radius_out, factor));
+    }
+    return res;
+  }
+}
+
+SimData::SimData(const Config& config,
+		 const EosTables& tables,
+		 const InitialData& id,
 		 const Units& u,
 		 const CircularSection& domain):
+  prof_(),
   pg_(Vector2D(0,0), Vector2D(1,0)),
   outer_(Vector2D(-0.5*id.radius_mid.front(),0.9*id.radius_mid.front()),
 	 Vector2D(0.5*id.radius_mid.front(),1.2*id.radius_mid.back())),
-  tess_(create_grid(outer_.getBoundary(),2e-3,0.9*id.radius_list.front()),
-	outer_),
-  eos_("eos_tab.coded",1,1,0,generate_atomic_properties()),
+  decomposition_(create_grid(domain,
+			     outer_.getBoundary(),
+			     config.getDouble("grid_dq",2e-3),
+			     parse_bands(config.getList("refinement_bands")),
+			     config.getSize("grid_halo",2)),
+		 domain,
+		 config.getInt("mpi_halo_layers",3)*
+		 config.getDouble("grid_dq",2e-3),
+		 mpi_rank(),
+		 mpi_size()),
+  tess_(decomposition_.getLocalPoints(), outer_),
+  eos_(tables,
+       config.getInt("eos_gas",1),
+       config.getInt("eos_photons",1),
+       config.getInt("eos_coulomb",0),
+       generate_atomic_properties()),
+  eos_cache_(eos_,
+	     config.getDouble("eos_cache_tolerance",1e-10),
+	     config.getBool("eos_cache_strict",false),
+	     prof_),
   rs_(),
   point_motion_(),
   cag_
   (u.core_mass,
-   linspace(id.radius_list.front(),id.radius_list.back(),100),
+   linspace(id.radius_list.front(),
+	    id.radius_list.back(),
+	    config.getInt("gravity_samples",100)),
    u.gravitation_constant,
-   domain.getAngles()),
+   domain.getAngles(),
+   prof_),
   geom_force_(pg_.getAxis()),
   force_(VectorInitialiser<SourceTerm*>
 	 (&cag_)
 	 (&geom_force_)
 	 ()),
-  tsf_(0.3),
+  local_tsf_(config.getDouble("cfl",0.3),eos_cache_),
+  tsf_(local_tsf_),
   fc_(rs_,string("ghost"),
-      cag_),
-  eu_(),
-  cu_(),
+      cag_,eos_cache_,prof_,
+      config.getBool("flux_batch_bulk",true)),
+  eu_(prof_),
+  cu_(eos_cache_,prof_),
   sim_(tess_,
        outer_,
        pg_,
-       calc_init_cond(tess_,eos_,id,domain),
+       cached_init_cond(tess_,eos_cache_,id,domain,
+			from_launch_directory
+			(config.getString("init_cond_cache_dir","."))),
        eos_,
        point_motion_,
        force_,
        tsf_,
        fc_,
        eu_,
-       cu_) {}
+       cu_),
+  advance_(point_motion_,
+	   force_,
+	   tsf_,
+	   fc_,
+	   eu_,
+	   cu_,
+	   eos_,
+	   config.getBool("static_mesh",true),
+	   prof_)
+{
+  mark_halo(decomposition_, sim_.getAllCells());
+}
 
 hdsim& SimData::getSim(void)
 {
   return sim_;
 }
 
+StaticMeshAdvance& SimData::getAdvance(void)
+{
+  return advance_;
+}
+
 const FermiTable& SimData::getEOS(void) const
 {
   return eos_;
 }
+
+EosCache& SimData::getEOSCache(void)
+{
+  return eos_cache_;
+}
+
+PhaseProfiler& SimData::getProfiler(void)
+{
+  return prof_;
+}
+
+const InnerBC& SimData::getFluxCalculator(void) const
+{
+  return fc_;
+}
+
+const CoreAtmosphereGravity& SimData::getGravity(void) const
+{
+  return cag_;
+}
+
+const AngularDecomposition& SimData::getDecomposition(void) const
+{
+  return decomposition_;
+}
+
+InitialData load_initial_data(const Config& config)
+{
+  return InitialData
+    (config.getString("radius_file","radius_list.txt"),
+     config.getString("density_file","density_list.txt"),
+     config.getString("temperature_file","temperature_list.txt"),
+     config.getString("velocity_file","velocity_list.txt"));
+}
+
+CircularSection wedge_domain(const Config& config, const InitialData& id)
+{
+  return CircularSection(id.radius_mid.front(),
+			 id.radius_mid.back(),
+			 config.getDouble("wedge_left",0.49)*M_PI,
+			 config.getDouble("wedge_right",0.51)*M_PI);
+}
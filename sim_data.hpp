@@ -16,40 +16,89 @@
 #include "inner_bc.hpp"
 #include "lazy_extensive_updater.hpp"
 #include "lazy_cell_updater.hpp"
+#include "eos_cache.hpp"
 #include "create_grid.hpp"
 #include "generate_atomic_properties.hpp"
 #include "source/misc/vector_initialiser.hpp"
 #include "circular_section.hpp"
-#include "calc_init_cond.hpp"
+#include "init_cond_cache.hpp"
 #include "core_atmosphere_gravity.hpp"
+#include "phase_profiler.hpp"
+#include "config.hpp"
+#include "angular_decomposition.hpp"
+#include "global_time_step.hpp"
+#include "lazy_cfl.hpp"
+#include "static_mesh_advance.hpp"
 
 class SimData
 {
 public:
 
-  SimData(const InitialData& id,
+  /*! \brief Class constructor
+    \param config Run parameters: grid_dq, grid_halo, refinement_bands (r_in:r_out:factor,...), eos_gas, eos_photons, eos_coulomb, eos_cache_tolerance, eos_cache_strict, gravity_samples, cfl, flux_batch_bulk, mpi_halo_layers, static_mesh and init_cond_cache_dir
+    \param tables Equation of state tables
+    \param id Initial profiles
+    \param u Units
+    \param domain Wedge of live cells
+   */
+  SimData(const Config& config,
+	  const EosTables& tables,
+	  const InitialData& id,
 	  const Units& u,
 	  const CircularSection& domain);
 
   hdsim& getSim(void);
 
+  //! \brief Time step of the simulation, on a fixed mesh unless disabled
+  StaticMeshAdvance& getAdvance(void);
+
   const FermiTable& getEOS(void) const;
 
+  //! \brief Per cell equation of state results, shared by the updater, fluxes, burn and diagnostics
+  EosCache& getEOSCache(void);
+
+  PhaseProfiler& getProfiler(void);
+
+  const InnerBC& getFluxCalculator(void) const;
+
+  const CoreAtmosphereGravity& getGravity(void) const;
+
+  //! \brief Cells of this rank, and how they are shared with the others
+  const AngularDecomposition& getDecomposition(void) const;
+
 private:
+  PhaseProfiler prof_;
   const CylindricalSymmetry pg_;
   const SquareBox outer_;
+  const AngularDecomposition decomposition_;
   VoronoiMesh tess_;
   const FermiTable eos_;
+  EosCache eos_cache_;
   const Hllc rs_;
   Eulerian point_motion_;
   CoreAtmosphereGravity cag_;
   CylindricalComplementary geom_force_;
   SeveralSources force_;
-  const SimpleCFL tsf_;
+  const LazyCFL local_tsf_;
+  const GlobalTimeStep tsf_;
   const InnerBC fc_;
   const LazyExtensiveUpdater eu_;
   const LazyCellUpdater cu_;
   hdsim sim_;
+  StaticMeshAdvance advance_;
 };
 
+/*! \brief Reads the initial profiles
+  \param config Run parameters: radius_file, density_file, temperature_file and velocity_file
+  \return Initial profiles
+ */
+InitialData load_initial_data(const Config& config);
+
+/*! \brief Wedge of live cells, between the inner and outer mid radii of the profiles
+  \param config Run parameters: wedge_left and wedge_right, in units of pi
+  \param id Initial profiles
+  \return Domain
+ */
+CircularSection wedge_domain(const Config& config, const InitialData& id);
+
 #endif // SIM_DATA_HPP
@@ -0,0 +1,288 @@
+#include <algorithm>
+#include "H5Cpp.h"
+#include "snapshot_data.hpp"
+#include "source/tessellation/ConvexHull.hpp"
+#include "fnv_hash.hpp"
+
+using namespace H5;
+
+SnapshotData::SnapshotData(void):
+  time(0),
+  cycle(0),
+  x_coordinate(),
+  y_coordinate(),
+  x_vertices(),
+  y_vertices(),
+  vertex_counts(),
+  density(),
+  pressure(),
+  x_velocity(),
+  y_velocity(),
+  tracers(),
+  stickers(),
+  appendices() {}
+
+void stage_snapshot(const hdsim& sim,
+		    const vector<DiagnosticAppendix*>& appendices,
+		    SnapshotData& res)
+{
+  const Tessellation& tess = sim.getTessellation();
+  const vector<ComputationalCell>& cells = sim.getAllCells();
+  const size_t n = static_cast<size_t>(tess.GetPointNo());
+  res.time = sim.getTime();
+  res.cycle = sim.getCycle();
+  res.x_coordinate.resize(n);
+  res.y_coordinate.resize(n);
+  res.vertex_counts.clear();
+  res.x_vertices.clear();
+  res.y_vertices.clear();
+  res.density.resize(n);
+  res.pressure.resize(n);
+  res.x_velocity.resize(n);
+  res.y_velocity.resize(n);
+  res.tracers.clear();
+  res.stickers.clear();
+  res.appendices.clear();
+  for(size_t i=0;i<n;++i){
+    const Vector2D& r = tess.GetMeshPoint(static_cast<int>(i));
+    res.x_coordinate[i] = r.x;
+    res.y_coordinate[i] = r.y;
+    const ComputationalCell& cell = cells[i];
+    res.density[i] = cell.density;
+    res.pressure[i] = cell.pressure;
+    res.x_velocity[i] = cell.velocity.x;
+    res.y_velocity[i] = cell.velocity.y;
+  }
+  if(!cells.empty()){
+    for(boost::container::flat_map<string,double>::const_iterator it=
+	  cells.front().tracers.begin();
+	it!=cells.front().tracers.end();
+	++it){
+      vector<double>& field = res.tracers[it->first];
+      field.resize(n);
+      for(size_t i=0;i<n;++i)
+	field[i] = cells[i].tracers.find(it->first)->second;
+    }
+    for(boost::container::flat_map<string,bool>::const_iterator it=
+	  cells.front().stickers.begin();
+	it!=cells.front().stickers.end();
+	++it){
+      vector<double>& field = res.stickers[it->first];
+      field.resize(n);
+      for(size_t i=0;i<n;++i)
+	field[i] = cells[i].stickers.find(it->first)->second ? 1 : 0;
+    }
+  }
+  for(size_t i=0;i<appendices.size();++i)
+    res.appendices[appendices[i]->getName()] = (*appendices[i])(sim);
+}
+
+void stage_vertices(const Tessellation& tess,
+		    SnapshotData& res)
+{
+  const size_t n = static_cast<size_t>(tess.GetPointNo());
+  res.vertex_counts.resize(n);
+  res.x_vertices.clear();
+  res.y_vertices.clear();
+  vector<Vector2D> hull;
+  for(size_t i=0;i<n;++i){
+    ConvexHull(hull, tess, static_cast<int>(i));
+    res.vertex_counts[i] = static_cast<int>(hull.size());
+    for(size_t j=0;j<hull.size();++j){
+      res.x_vertices.push_back(hull[j].x);
+      res.y_vertices.push_back(hull[j].y);
+    }
+  }
+}
+
+string mesh_hash(const SnapshotData& data, bool drop_ghosts)
+{
+  FnvHash hash;
+  const char dropped = drop_ghosts ? 1 : 0;
+  hash.add(&dropped, sizeof(dropped));
+  hash.add(data.x_coordinate);
+  hash.add(data.y_coordinate);
+  const map<string,vector<double> >::const_iterator ghost =
+    data.stickers.find("ghost");
+  if(ghost!=data.stickers.end())
+    hash.add(ghost->second);
+  return hash.hex();
+}
+
+namespace {
+
+  class FieldWriter
+  {
+  public:
+
+    FieldWriter(H5File& file,
+		const SnapshotLayout& layout,
+		const vector<size_t>& live):
+      file_(file), layout_(layout), live_(live) {}
+
+    template<class T> void operator()(const vector<T>& data,
+				      const string& name,
+				      const PredType& type) const
+    {
+      const hsize_t dims[1] = {static_cast<hsize_t>(data.size())};
+      const DataSpace space(1, dims);
+      DSetCreatPropList plist;
+      if(!data.empty() && layout_.chunk_size>0){
+	const hsize_t chunk[1] =
+	  {static_cast<hsize_t>(std::min(data.size(),layout_.chunk_size))};
+	plist.setChunk(1, chunk);
+	if(layout_.shuffle)
+	  plist.setShuffle();
+	if(layout_.deflate_level>0)
+	  plist.setDeflate(layout_.deflate_level);
+      }
+      DataSet dataset = file_.createDataSet(name, type, space, plist);
+      if(!data.empty())
+	dataset.write(&data[0], type);
+    }
+
+    template<class T> void cellField(const vector<T>& data,
+				     const string& name,
+				     const PredType& type) const
+    {
+      if(!layout_.selected(name))
+	return;
+      if(!layout_.drop_ghosts){
+	(*this)(data, name, type);
+	return;
+      }
+      vector<T> res(live_.size());
+      for(size_t i=0;i<live_.size();++i)
+	res[i] = data[live_[i]];
+      (*this)(res, name, type);
+    }
+
+    void cellFields(const map<string,vector<double> >& fields) const
+    {
+      for(map<string,vector<double> >::const_iterator it=
+	    fields.begin();
+	  it!=fields.end();
+	  ++it)
+	cellField(it->second, it->first, PredType::NATIVE_DOUBLE);
+    }
+
+    void vertices(const SnapshotData& data) const
+    {
+      if(!layout_.selected("vertices"))
+	return;
+      if(!layout_.drop_ghosts){
+	(*this)(data.x_vertices, "x position of vertices",
+		PredType::NATIVE_DOUBLE);
+	(*this)(data.y_vertices, "y position of vertices",
+		PredType::NATIVE_DOUBLE);
+	(*this)(data.vertex_counts, "Number of vertices in cell",
+		PredType::NATIVE_INT);
+	return;
+      }
+      vector<size_t> offsets(data.vertex_counts.size()+1,0);
+      for(size_t i=0;i<data.vertex_counts.size();++i)
+	offsets[i+1] = offsets[i] +
+	  static_cast<size_t>(data.vertex_counts[i]);
+      vector<double> x_vertices;
+      vector<double> y_vertices;
+      vector<int> vertex_counts(live_.size());
+      for(size_t i=0;i<live_.size();++i){
+	const size_t cell = live_[i];
+	vertex_counts[i] = data.vertex_counts[cell];
+	for(size_t j=offsets[cell];j<offsets[cell+1];++j){
+	  x_vertices.push_back(data.x_vertices[j]);
+	  y_vertices.push_back(data.y_vertices[j]);
+	}
+      }
+      (*this)(x_vertices, "x position of vertices",
+	      PredType::NATIVE_DOUBLE);
+      (*this)(y_vertices, "y position of vertices",
+	      PredType::NATIVE_DOUBLE);
+      (*this)(vertex_counts, "Number of vertices in cell",
+	      PredType::NATIVE_INT);
+    }
+
+  private:
+    H5File& file_;
+    const SnapshotLayout& layout_;
+    const vector<size_t>& live_;
+  };
+
+  vector<size_t> live_cells(const SnapshotData& data)
+  {
+    vector<size_t> res;
+    const map<string,vector<double> >::const_iterator ghost =
+      data.stickers.find("ghost");
+    for(size_t i=0;i<data.density.size();++i){
+      if(ghost==data.stickers.end() || ghost->second[i]<0.5)
+	res.push_back(i);
+    }
+    return res;
+  }
+
+  void write_string_attribute(H5File& file,
+			      const string& name,
+			      const string& value)
+  {
+    const StrType type(PredType::C_S1, value.size());
+    Attribute attribute = file.createAttribute
+      (name, type, DataSpace(H5S_SCALAR));
+    attribute.write(type, value);
+  }
+}
+
+void write_geometry(const SnapshotData& data,
+		    const string& fname,
+		    const SnapshotLayout& layout,
+		    const string& hash)
+{
+  H5File file(fname, H5F_ACC_TRUNC);
+  const vector<size_t> live = live_cells(data);
+  const SnapshotLayout all_fields(layout.deflate_level,
+				  layout.shuffle,
+				  layout.chunk_size,
+				  vector<string>(),
+				  layout.drop_ghosts,
+				  layout.shared_geometry);
+  const FieldWriter write(file, all_fields, live);
+  write.cellField(data.x_coordinate, "x_coordinate",
+		  PredType::NATIVE_DOUBLE);
+  write.cellField(data.y_coordinate, "y_coordinate",
+		  PredType::NATIVE_DOUBLE);
+  write.vertices(data);
+  const map<string,vector<double> >::const_iterator ghost =
+    data.stickers.find("ghost");
+  if(ghost!=data.stickers.end())
+    write.cellField(ghost->second, ghost->first, PredType::NATIVE_DOUBLE);
+  write_string_attribute(file, "geometry_hash", hash);
+}
+
+void write_snapshot(const SnapshotData& data,
+		    const string& fname,
+		    const SnapshotLayout& layout,
+		    const string& geometry_file,
+		    const string& geometry_hash)
+{
+  H5File file(fname, H5F_ACC_TRUNC);
+  const vector<size_t> live = live_cells(data);
+  const FieldWriter write(file, layout, live);
+  write(vector<double>(1,data.time), "time", PredType::NATIVE_DOUBLE);
+  write(vector<int>(1,data.cycle), "cycle", PredType::NATIVE_INT);
+  write.cellField(data.x_coordinate, "x_coordinate",
+		  PredType::NATIVE_DOUBLE);
+  write.cellField(data.y_coordinate, "y_coordinate",
+		  PredType::NATIVE_DOUBLE);
+  if(geometry_file.empty())
+    write.vertices(data);
+  else{
+    write_string_attribute(file, "geometry_file", geometry_file);
+    write_string_attribute(file, "geometry_hash", geometry_hash);
+  }
+  write.cellField(data.density, "density", PredType::NATIVE_DOUBLE);
+  write.cellField(data.pressure, "pressure", PredType::NATIVE_DOUBLE);
+  write.cellField(data.x_velocity, "x_velocity", PredType::NATIVE_DOUBLE);
+  write.cellField(data.y_velocity, "y_velocity", PredType::NATIVE_DOUBLE);
+  write.cellFields(data.tracers);
+  write.cellFields(data.stickers);
+  write.cellFields(data.appendices);
+}
@@ -0,0 +1,85 @@
+#ifndef SNAPSHOT_DATA_HPP
+#define SNAPSHOT_DATA_HPP 1
+
+#include <vector>
+#include <map>
+#include <string>
+#include "source/newtonian/two_dimensional/hdf5_diagnostics.hpp"
+#include "snapshot_layout.hpp"
+
+using std::vector;
+using std::map;
+using std::string;
+
+//! \brief Copy of everything that goes into a snapshot file
+class SnapshotData
+{
+public:
+
+  SnapshotData(void);
+
+  double time;
+  int cycle;
+  vector<double> x_coordinate;
+  vector<double> y_coordinate;
+  vector<double> x_vertices;
+  vector<double> y_vertices;
+  vector<int> vertex_counts;
+  vector<double> density;
+  vector<double> pressure;
+  vector<double> x_velocity;
+  vector<double> y_velocity;
+  map<string,vector<double> > tracers;
+  map<string,vector<double> > stickers;
+  map<string,vector<double> > appendices;
+};
+
+/*! \brief Copies the state of the simulation into a staging buffer, without the cell vertices
+  \param sim Simulation
+  \param appendices Additional fields, evaluated during staging
+  \param res Staging buffer, overwritten
+ */
+void stage_snapshot(const hdsim& sim,
+		    const vector<DiagnosticAppendix*>& appendices,
+		    SnapshotData& res);
+
+/*! \brief Copies the cell vertices into a staging buffer
+  \param tess Tessellation
+  \param res Staging buffer
+ */
+void stage_vertices(const Tessellation& tess,
+		    SnapshotData& res);
+
+/*! \brief Identifies the mesh of a staged snapshot
+  \details Hash of the mesh generating points, the ghost sticker and whether ghosts are dropped, so a mesh that does not move keeps the same value
+  \param data Staged snapshot
+  \param drop_ghosts Whether the geometry file omits ghost cells
+  \return Hash as hexadecimal digits
+ */
+string mesh_hash(const SnapshotData& data, bool drop_ghosts);
+
+/*! \brief Writes the mesh generating points and cell vertices of a staged snapshot
+  \param data Staged snapshot, with vertices
+  \param fname Name of output file
+  \param layout Compression and ghost filtering
+  \param hash Mesh hash
+ */
+void write_geometry(const SnapshotData& data,
+		    const string& fname,
+		    const SnapshotLayout& layout,
+		    const string& hash);
+
+/*! \brief Writes a staged snapshot, with the same dataset names as write_snapshot_to_hdf5
+  \param data Staged snapshot
+  \param fname Name of output file
+  \param layout Compression and field selection
+  \param geometry_file File holding the cell vertices, or empty to write them to this file. The "vertices" field name selects the vertex datasets.
+  \param geometry_hash Mesh hash, stored next to the geometry file name
+ */
+void write_snapshot(const SnapshotData& data,
+		    const string& fname,
+		    const SnapshotLayout& layout,
+		    const string& geometry_file,
+		    const string& geometry_hash);
+
+#endif // SNAPSHOT_DATA_HPP
@@ -0,0 +1,34 @@
+#include <cassert>
+#include <algorithm>
+#include "snapshot_layout.hpp"
+
+SnapshotLayout::SnapshotLayout(void):
+  deflate_level(0),
+  shuffle(false),
+  chunk_size(0),
+  fields(),
+  drop_ghosts(false),
+  shared_geometry(false) {}
+
+SnapshotLayout::SnapshotLayout(int deflate_level_i,
+			       bool shuffle_i,
+			       size_t chunk_size_i,
+			       const vector<string>& fields_i,
+			       bool drop_ghosts_i,
+			       bool shared_geometry_i):
+  deflate_level(deflate_level_i),
+  shuffle(shuffle_i),
+  chunk_size(chunk_size_i),
+  fields(fields_i),
+  drop_ghosts(drop_ghosts_i),
+  shared_geometry(shared_geometry_i)
+{
+  assert(deflate_level>=0 && deflate_level<=9);
+  assert(chunk_size>0 || (deflate_level==0 && !shuffle));
+}
+
+bool SnapshotLayout::selected(const string& name) const
+{
+  return fields.empty() ||
+    std::find(fields.begin(),fields.end(),name)!=fields.end();
+}
@@ -0,0 +1,49 @@
+#ifndef SNAPSHOT_LAYOUT_HPP
+#define SNAPSHOT_LAYOUT_HPP 1
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+using std::vector;
+using std::string;
+using std::size_t;
+
+//! \brief Storage options for snapshot files
+class SnapshotLayout
+{
+public:
+
+  //! \brief Uncompressed, contiguous, all fields and cells
+  SnapshotLayout(void);
+
+  /*! \brief Class constructor
+    \param deflate_level Gzip level, between 0 (no compression) and 9
+    \param shuffle Apply the byte shuffle filter before compression
+    \param chunk_size Number of values per chunk
+    \param fields Fields to write, or empty for all fields
+    \param drop_ghosts Only write live cells
+    \param shared_geometry Write the cell vertices to a mesh file, once per mesh version, and refer to it from the snapshots
+   */
+  SnapshotLayout(int deflate_level,
+		 bool shuffle,
+		 size_t chunk_size,
+		 const vector<string>& fields,
+		 bool drop_ghosts,
+		 bool shared_geometry);
+
+  /*! \brief Checks whether a field should be written
+    \param name Field name
+    \return True if the field is selected
+   */
+  bool selected(const string& name) const;
+
+  const int deflate_level;
+  const bool shuffle;
+  const size_t chunk_size;
+  const vector<string> fields;
+  const bool drop_ghosts;
+  const bool shared_geometry;
+};
+
+#endif // SNAPSHOT_LAYOUT_HPP
@@ -0,0 +1,282 @@
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <cassert>
+#include "spherical_sim.hpp"
+
+namespace {
+
+  // Centre of mass of a uniform shell
+  vector<double> shell_radii(const vector<double>& edges)
+  {
+    vector<double> res(edges.size()-1);
+    for(size_t i=0;i<res.size();++i)
+      res[i] = 0.75*(pow(edges[i+1],4)-pow(edges[i],4))/
+	(pow(edges[i+1],3)-pow(edges[i],3));
+    return res;
+  }
+
+  vector<double> face_areas(const vector<double>& edges)
+  {
+    vector<double> res(edges.size());
+    for(size_t i=0;i<res.size();++i)
+      res[i] = 4*M_PI*edges[i]*edges[i];
+    return res;
+  }
+
+  vector<double> shell_volumes(const vector<double>& edges)
+  {
+    vector<double> res(edges.size()-1);
+    for(size_t i=0;i<res.size();++i)
+      res[i] = 4*M_PI*(pow(edges[i+1],3)-pow(edges[i],3))/3;
+    return res;
+  }
+}
+
+SphericalSim::SphericalSim(const vector<double>& edges,
+			   const vector<ComputationalCell>& cells,
+			   EosCache& eos_cache,
+			   double core_mass,
+			   const vector<double>& sample_radii,
+			   double gravitation_constant,
+			   double cfl,
+			   PhaseProfiler& prof):
+  edges_(edges),
+  radii_(shell_radii(edges)),
+  areas_(face_areas(edges)),
+  volumes_(shell_volumes(edges)),
+  cells_(cells),
+  eos_cache_(eos_cache),
+  core_mass_(core_mass),
+  sample_radii_(sample_radii),
+  gravitation_constant_(gravitation_constant),
+  cfl_(cfl),
+  time_(0),
+  cycle_(0),
+  mass_(cells.size()),
+  momentum_(cells.size()),
+  energy_(cells.size()),
+  tracer_mass_(cells.size()*cells.front().tracers.size()),
+  thermal_energies_(cells.size()),
+  sound_speeds_(cells.size()),
+  accelerations_(cells.size()),
+  solver_(),
+  batch_(cells.size()+1),
+  tracer_fluxes_(),
+  prof_(prof),
+  phase_(prof.addPhase("spherical_step"))
+{
+  if(edges.size()!=cells.size()+1)
+    throw "SphericalSim: expected one more edge than cells";
+  recalculateExtensives();
+}
+
+void SphericalSim::recalculateExtensives(void)
+{
+  const size_t n_species = cells_.front().tracers.size();
+  for(size_t i=0;i<cells_.size();++i){
+    const ComputationalCell& cell = cells_[i];
+    const FermiTable::ThermodynamicVariables tv =
+      eos_cache_.dp2state(i, cell.density, cell.pressure, cell.tracers);
+    const double mass = volumes_[i]*cell.density;
+    const double velocity = cell.velocity.x;
+    mass_[i] = mass;
+    momentum_[i] = mass*velocity;
+    energy_[i] = mass*(tv.energy+0.5*velocity*velocity);
+    assert(cell.tracers.size()==n_species);
+    size_t k = 0;
+    for(boost::container::flat_map<string,double>::const_iterator it =
+	  cell.tracers.begin();
+	it!=cell.tracers.end();
+	++it, ++k)
+      tracer_mass_[i*n_species+k] = mass*it->second;
+  }
+}
+
+void SphericalSim::setSide(BulkHllc::States& states,
+			   size_t face,
+			   size_t cell,
+			   double pressure,
+			   double velocity) const
+{
+  states.density[face] = cells_[cell].density;
+  states.pressure[face] = pressure;
+  states.energy[face] = thermal_energies_[cell];
+  states.sound_speed[face] = sound_speeds_[cell];
+  states.normal_velocity[face] = velocity;
+  states.parallel_velocity[face] = 0;
+}
+
+void SphericalSim::calcFluxes(void)
+{
+  const size_t n = cells_.size();
+  // The inner boundary supports the first shell: the reflected shell is
+  // solved against it, and only the momentum flux is kept
+  setSide(batch_.left, 0, 0, cells_[0].pressure, -cells_[0].velocity.x);
+  setSide(batch_.right, 0, 0, cells_[0].pressure, cells_[0].velocity.x);
+  // Face pressures are extrapolated along the gravitational acceleration,
+  // as in the bulk of the wedge
+  for(size_t f=1;f<n;++f){
+    const ComputationalCell& left = cells_[f-1];
+    const ComputationalCell& right = cells_[f];
+    setSide(batch_.left, f, f-1,
+	    left.pressure+left.density*accelerations_[f-1]*
+	    (edges_[f]-radii_[f-1]),
+	    left.velocity.x);
+    setSide(batch_.right, f, f,
+	    right.pressure+right.density*accelerations_[f]*
+	    (edges_[f]-radii_[f]),
+	    right.velocity.x);
+  }
+  // Outflow through the outer boundary, but no inflow
+  const ComputationalCell& last = cells_[n-1];
+  setSide(batch_.left, n, n-1, last.pressure, last.velocity.x);
+  setSide(batch_.right, n, n-1, last.pressure,
+	  last.velocity.x<0 ? -last.velocity.x : last.velocity.x);
+  std::fill(batch_.face_velocity.begin(), batch_.face_velocity.end(), 0);
+  solver_(batch_);
+  batch_.mass[0] = 0;
+  batch_.energy[0] = 0;
+
+  // Tracers flow with the mass, from the upwind shell
+  const size_t n_species = cells_.front().tracers.size();
+  tracer_fluxes_.assign((n+1)*n_species, 0);
+  for(size_t f=0;f<=n;++f){
+    const double flux = batch_.mass[f];
+    if(!(flux>0 ? f>0 : (flux<0 && f<n)))
+      continue;
+    const size_t donor = flux>0 ? f-1 : f;
+    for(size_t k=0;k<n_species;++k)
+      tracer_fluxes_[f*n_species+k] =
+	flux*tracer_mass_[donor*n_species+k]/mass_[donor];
+  }
+}
+
+void SphericalSim::timeAdvance(void)
+{
+  const PhaseProfiler::ScopedTimer timer(prof_, phase_);
+  const size_t n = cells_.size();
+  double dt = std::numeric_limits<double>::max();
+  vector<pair<double,double> > mass_radius_list(n);
+  for(size_t i=0;i<n;++i){
+    const ComputationalCell& cell = cells_[i];
+    const FermiTable::ThermodynamicVariables tv =
+      eos_cache_.dp2state(i, cell.density, cell.pressure, cell.tracers);
+    thermal_energies_[i] = tv.energy;
+    sound_speeds_[i] = tv.sound_speed;
+    dt = std::min(dt, (edges_[i+1]-edges_[i])/
+		  (tv.sound_speed+std::abs(cell.velocity.x)));
+    mass_radius_list[i] =
+      pair<double,double>(radii_[i], volumes_[i]*cell.density);
+  }
+  dt *= cfl_;
+  // The shells are whole spheres, so no section to shell factor
+  const CoreAtmosphereGravity::EnclosedMassCalculator emc
+    (core_mass_, mass_radius_list, sample_radii_, 1);
+  const CoreAtmosphereGravity::AccelerationCalculator ac
+    (gravitation_constant_, emc);
+  for(size_t i=0;i<n;++i)
+    accelerations_[i] = ac(Vector2D(radii_[i],0)).x;
+
+  calcFluxes();
+
+  const size_t n_species = cells_.front().tracers.size();
+  for(size_t i=0;i<n;++i){
+    const double inner = areas_[i];
+    const double outer = areas_[i+1];
+    const double weight = volumes_[i]*cells_[i].density*accelerations_[i];
+    mass_[i] += dt*(batch_.mass[i]*inner-batch_.mass[i+1]*outer);
+    // The pressure on the side walls of the shell
+    momentum_[i] += dt*(batch_.normal_momentum[i]*inner-
+			batch_.normal_momentum[i+1]*outer+
+			cells_[i].pressure*(outer-inner)+
+			weight);
+    energy_[i] += dt*(batch_.energy[i]*inner-
+		      batch_.energy[i+1]*outer+
+		      weight*cells_[i].velocity.x);
+    for(size_t k=0;k<n_species;++k)
+      tracer_mass_[i*n_species+k] +=
+	dt*(tracer_fluxes_[i*n_species+k]*inner-
+	    tracer_fluxes_[(i+1)*n_species+k]*outer);
+  }
+  updateCells();
+  time_ += dt;
+  ++cycle_;
+}
+
+void SphericalSim::updateCells(void)
+{
+  const size_t n_species = cells_.front().tracers.size();
+  for(size_t i=0;i<cells_.size();++i){
+    ComputationalCell& cell = cells_[i];
+    cell.density = mass_[i]/volumes_[i];
+    const double velocity = momentum_[i]/mass_[i];
+    cell.velocity = Vector2D(velocity,0);
+    const double thermal_energy =
+      energy_[i]/mass_[i] - 0.5*velocity*velocity;
+    size_t k = 0;
+    for(boost::container::flat_map<string,double>::iterator it =
+	  cell.tracers.begin();
+	it!=cell.tracers.end();
+	++it, ++k)
+      it->second = tracer_mass_[i*n_species+k]/mass_[i];
+    const FermiTable::ThermodynamicVariables tv =
+      eos_cache_.de2state(i, cell.density, thermal_energy, cell.tracers);
+    cell.pressure = tv.pressure;
+  }
+}
+
+double SphericalSim::getTime(void) const
+{
+  return time_;
+}
+
+int SphericalSim::getCycle(void) const
+{
+  return cycle_;
+}
+
+const vector<ComputationalCell>& SphericalSim::getCells(void) const
+{
+  return cells_;
+}
+
+vector<ComputationalCell>& SphericalSim::getCells(void)
+{
+  return cells_;
+}
+
+const vector<double>& SphericalSim::getRadii(void) const
+{
+  return radii_;
+}
+
+const vector<double>& SphericalSim::getVolumes(void) const
+{
+  return volumes_;
+}
+
+vector<ComputationalCell> spherical_init_cond(const InitialData& id,
+					      const FermiTable& eos)
+{
+  const size_t n = id.radius_mid.size();
+  if(id.density_list.size()!=n || id.temperature_list.size()!=n)
+    throw "spherical_init_cond: profiles do not match the shells";
+  vector<ComputationalCell> res(n);
+  for(size_t i=0;i<n;++i){
+    ComputationalCell& cell = res[i];
+    cell.density = id.density_list[i];
+    cell.velocity =
+      Vector2D(0.5*(id.velocity_list[i]+id.velocity_list[i+1]),0);
+    for(map<string,vector<double> >::const_iterator it =
+	  id.tracers_list.begin();
+	it!=id.tracers_list.end();
+	++it)
+      cell.tracers[it->first] = it->second.at(i);
+    cell.stickers["ghost"] = false;
+    cell.pressure = eos.dt2paz(cell.density,
+			       id.temperature_list[i],
+			       eos.calcAverageAtomicProperties(cell.tracers));
+  }
+  return res;
+}
@@ -0,0 +1,116 @@
+#ifndef SPHERICAL_SIM_HPP
+#define SPHERICAL_SIM_HPP 1
+
+#include <vector>
+#include "source/newtonian/two_dimensional/computational_cell_2d.hpp"
+#include "eos_cache.hpp"
+#include "bulk_hllc.hpp"
+#include "core_atmosphere_gravity.hpp"
+#include "phase_profiler.hpp"
+#include "initial_data.hpp"
+
+using std::vector;
+
+/*! \brief Spherically symmetric hydrodynamics on fixed radial shells
+  \details A first order finite volume scheme, with the same physics as
+  the wedge runs:
+  - the HLLC solver, with the face pressures corrected for gravity
+  - the enclosed mass profile of CoreAtmosphereGravity
+  - the equation of state cache
+  - a supporting inner boundary that carries momentum but no mass or
+    energy
+  - an outer boundary that lets matter out but reflects it on the way in
+  Cells are ComputationalCell objects with the radial velocity in x, so
+  NuclearBurn and the cache work on them unchanged.
+ */
+class SphericalSim
+{
+public:
+
+  /*! \brief Class constructor
+    \param edges Shell boundaries, increasing
+    \param cells Initial cells, one per shell
+    \param eos_cache Equation of state, with the per cell results
+    \param core_mass Mass inside the inner boundary
+    \param sample_radii Radii of the enclosed mass profile
+    \param gravitation_constant Gravitation constant
+    \param cfl Courant number
+    \param prof Profiler
+   */
+  SphericalSim(const vector<double>& edges,
+	       const vector<ComputationalCell>& cells,
+	       EosCache& eos_cache,
+	       double core_mass,
+	       const vector<double>& sample_radii,
+	       double gravitation_constant,
+	       double cfl,
+	       PhaseProfiler& prof);
+
+  //! \brief Advances the cells by one time step
+  void timeAdvance(void);
+
+  //! \brief Recomputes the conserved variables after the cells were changed
+  void recalculateExtensives(void);
+
+  double getTime(void) const;
+
+  int getCycle(void) const;
+
+  const vector<ComputationalCell>& getCells(void) const;
+
+  vector<ComputationalCell>& getCells(void);
+
+  //! \brief Centre of mass radius of each shell
+  const vector<double>& getRadii(void) const;
+
+  const vector<double>& getVolumes(void) const;
+
+private:
+
+  //! \brief Writes one side of a face to the batch
+  void setSide(BulkHllc::States& states,
+	       size_t face,
+	       size_t cell,
+	       double pressure,
+	       double velocity) const;
+
+  void calcFluxes(void);
+
+  void updateCells(void);
+
+  const vector<double> edges_;
+  const vector<double> radii_;
+  const vector<double> areas_;
+  const vector<double> volumes_;
+  vector<ComputationalCell> cells_;
+  EosCache& eos_cache_;
+  const double core_mass_;
+  const vector<double> sample_radii_;
+  const double gravitation_constant_;
+  const double cfl_;
+  double time_;
+  int cycle_;
+  vector<double> mass_;
+  vector<double> momentum_;
+  vector<double> energy_;
+  //! \brief Mass of each tracer, shells by tracers
+  vector<double> tracer_mass_;
+  vector<double> thermal_energies_;
+  vector<double> sound_speeds_;
+  vector<double> accelerations_;
+  const BulkHllc solver_;
+  BulkHllc::Batch batch_;
+  vector<double> tracer_fluxes_;
+  PhaseProfiler& prof_;
+  const size_t phase_;
+};
+
+/*! \brief Cells on the shells of the initial profiles
+  \param id Initial profiles. Each shell lies between two consecutive radii
+  \param eos Equation of state
+  \return Cells, one per shell
+ */
+vector<ComputationalCell> spherical_init_cond(const InitialData& id,
+					      const FermiTable& eos);
+
+#endif // SPHERICAL_SIM_HPP
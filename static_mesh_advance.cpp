@@ -0,0 +1,87 @@
+#include "static_mesh_advance.hpp"
+
+namespace {
+  bool all_zero(const vector<Vector2D>& velocities)
+  {
+    for(size_t i=0;i<velocities.size();++i){
+      if(velocities[i].x!=0 || velocities[i].y!=0)
+	return false;
+    }
+    return true;
+  }
+}
+
+StaticMeshAdvance::StaticMeshAdvance(const PointMotion& point_motion,
+				     const SourceTerm& source,
+				     const TimeStepFunction& tsf,
+				     const FluxCalculator& fc,
+				     const ExtensiveUpdater& eu,
+				     const CellUpdater& cu,
+				     const EquationOfState& eos,
+				     bool enabled,
+				     PhaseProfiler& prof):
+  point_motion_(point_motion),
+  source_(source),
+  tsf_(tsf),
+  fc_(fc),
+  eu_(eu),
+  cu_(cu),
+  eos_(eos),
+  enabled_(enabled),
+  rebuild_requested_(false),
+  rebuilds_(0),
+  prof_(prof),
+  phase_(prof.addPhase("time_advance")),
+  counter_(prof.addCounter("mesh_rebuilds")) {}
+
+void StaticMeshAdvance::operator()(hdsim& sim)
+{
+  const PhaseProfiler::ScopedTimer timer(prof_, phase_);
+  const Tessellation& tess = sim.getTessellation();
+  const PhysicalGeometry& pg = sim.getPhysicalGeometry();
+  const CacheData& cd = sim.getCacheData();
+  vector<ComputationalCell>& cells = sim.getAllCells();
+  vector<Extensive>& extensives = sim.getAllExtensives();
+  const double time = sim.getTime();
+  const vector<Vector2D> point_velocities =
+    point_motion_(tess, cells, time);
+  if(!enabled_ || rebuild_requested_ || !all_zero(point_velocities)){
+    sim.TimeAdvance();
+    rebuild_requested_ = false;
+    ++rebuilds_;
+    prof_.count(counter_);
+    return;
+  }
+  // The same sequence as hdsim::TimeAdvance, without moving the points
+  const double dt = tsf_(tess, cells, eos_, point_velocities, time);
+  const vector<Extensive> fluxes =
+    fc_(tess, point_velocities, cells, extensives, cd, eos_, time, dt);
+  eu_(fluxes, pg, tess, dt, cd, cells, extensives);
+  const vector<Extensive> sources =
+    source_(tess, pg, cd, cells, fluxes, point_velocities, time);
+  for(size_t i=0;i<extensives.size();++i)
+    extensives[i] += dt*sources[i];
+  cells = cu_(tess, pg, eos_, extensives, cells, cd);
+  sim.setStartTime(time+dt);
+  sim.setCycle(sim.getCycle()+1);
+}
+
+void StaticMeshAdvance::requestRebuild(void)
+{
+  rebuild_requested_ = true;
+}
+
+bool StaticMeshAdvance::isEnabled(void) const
+{
+  return enabled_;
+}
+
+size_t StaticMeshAdvance::getRebuilds(void) const
+{
+  return rebuilds_;
+}
+
+double StaticMeshAdvance::getTotalTime(void) const
+{
+  return prof_.getTotalTimes().at(phase_);
+}
@@ -0,0 +1,71 @@
+#ifndef STATIC_MESH_ADVANCE_HPP
+#define STATIC_MESH_ADVANCE_HPP 1
+
+#include "source/newtonian/two_dimensional/hdsim2d.hpp"
+#include "phase_profiler.hpp"
+
+/*! \brief Time step of a simulation whose mesh points do not move
+  \details Follows hdsim::TimeAdvance, but skips moving the points, which
+  rebuilds the Voronoi tessellation even for zero velocities, and the reset
+  of the cached volumes, areas and centres of mass that follows it. The
+  tessellation and the cache of the simulation are kept across steps.
+  Steps whose point velocities are not all zero, and the step after a
+  rebuild request, go through hdsim::TimeAdvance instead. The components
+  must be the ones the simulation was built with.
+ */
+class StaticMeshAdvance
+{
+public:
+
+  /*! \brief Class constructor
+    \param point_motion Point motion
+    \param source Source terms
+    \param tsf Time step function
+    \param fc Flux calculator
+    \param eu Extensive updater
+    \param cu Cell updater
+    \param eos Equation of state
+    \param enabled False to always step through hdsim::TimeAdvance
+    \param prof Profiler
+   */
+  StaticMeshAdvance(const PointMotion& point_motion,
+		    const SourceTerm& source,
+		    const TimeStepFunction& tsf,
+		    const FluxCalculator& fc,
+		    const ExtensiveUpdater& eu,
+		    const CellUpdater& cu,
+		    const EquationOfState& eos,
+		    bool enabled,
+		    PhaseProfiler& prof);
+
+  //! \brief Advances the simulation by one time step
+  void operator()(hdsim& sim);
+
+  //! \brief Rebuilds the tessellation and the cache on the next step
+  void requestRebuild(void);
+
+  bool isEnabled(void) const;
+
+  //! \brief Steps that rebuilt the tessellation
+  size_t getRebuilds(void) const;
+
+  //! \brief Wall time spent in all steps so far
+  double getTotalTime(void) const;
+
+private:
+  const PointMotion& point_motion_;
+  const SourceTerm& source_;
+  const TimeStepFunction& tsf_;
+  const FluxCalculator& fc_;
+  const ExtensiveUpdater& eu_;
+  const CellUpdater& cu_;
+  const EquationOfState& eos_;
+  const bool enabled_;
+  bool rebuild_requested_;
+  size_t rebuilds_;
+  PhaseProfiler& prof_;
+  const size_t phase_;
+  const size_t counter_;
+};
+
+#endif // STATIC_MESH_ADVANCE_HPP
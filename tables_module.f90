@@ -1,6 +1,9 @@
 module tables
-  real(8),allocatable,save :: xtab(:),ytab(:)          &
-       ,etab(:,:),ptab(:,:),efer(:,:)
+  use iso_c_binding, only: c_int64_t
+! the tables are pointers so that set_tables can alias arrays owned by the
+! caller instead of copying them
+  real(8),pointer,contiguous,save :: xtab(:)=>null(),ytab(:)=>null() &
+       ,etab(:,:)=>null(),ptab(:,:)=>null(),efer(:,:)=>null()
   real(8),save :: dxtab,dytab,diuk=1.d-9
   real(8),save :: rho0,tmp0,enr0,prs0,ent0             & 
        ,rho,tmp,enr,prs,entropy,xfermi                 &
@@ -10,6 +13,8 @@ module tables
   integer,save :: init=0,ninterp=4,itmax=100,itab,jtab &
        ,inc_gas=1,inc_photons=1,keyerr,key_Coulomb=1
   real(8),save :: cinterp(4,5)
+! number of rho_tmp evaluations, read by the caller to count iterations
+  integer(c_int64_t),bind(c,name='eos_rho_tmp_calls') :: rho_tmp_calls=0
 ! =========================================================================
 contains
   subroutine rd_tables (tab_file)
@@ -17,23 +22,7 @@ contains
     include 'real8.com'
     character*80 header,label
     character*(*) tab_file
-! --------------------------------------------------------------------------
-!                define interpolation constants
-!      
-    nint=ninterp
-    if(nint.eq.4) then
-!       3trd order- 4 coeeficients
-       cinterp(1,1:nint)= (/0.d0,-0.5d0, 1.0d0,-0.5d0/)
-       cinterp(2,1:nint)= (/1.d0,0.d0  ,-2.5d0, 1.5d0/)
-       cinterp(3,1:nint)= (/0.d0,0.5d0 ,2.d0  ,-1.5d0/)
-       cinterp(4,1:nint)= (/0.d0,0.d0  ,-0.5d0, 0.5d0/)
-    else if (nint.eq.5) then
-!       4th order- 5 coeeficients
-       cinterp(1,1:nint)= (/0.d0,-0.5d0, 2.0d0,-2.5d0, 1.d0/)
-       cinterp(2,1:nint)= (/1.d0,0.d0  ,-3.5d0, 3.5d0,-1.d0/)
-       cinterp(3,1:nint)= (/0.d0,0.5d0 ,1.d0  ,0.5d0 ,-1.d0/)
-       cinterp(4,1:nint)= (/0.d0,0.d0  ,0.5d0 ,-1.5d0, 1.d0/)
-    endif
+    call set_interp_constants
 ! --------------------------------------------------------------------------
     nt=77
     ibin=0        !!!
@@ -87,6 +76,50 @@ contains
 !    write(*,144) tmp_min,tmp_max
 144 format(' EOS- tmp_min,tmp_max ',2es12.4)
   end subroutine rd_tables
+! =========================================================================
+  subroutine set_interp_constants
+! --------------------------------------------
+    include 'real8.com'
+!                define interpolation constants
+!      
+    nint=ninterp
+    if(nint.eq.4) then
+!       3trd order- 4 coeeficients
+       cinterp(1,1:nint)= (/0.d0,-0.5d0, 1.0d0,-0.5d0/)
+       cinterp(2,1:nint)= (/1.d0,0.d0  ,-2.5d0, 1.5d0/)
+       cinterp(3,1:nint)= (/0.d0,0.5d0 ,2.d0  ,-1.5d0/)
+       cinterp(4,1:nint)= (/0.d0,0.d0  ,-0.5d0, 0.5d0/)
+    else if (nint.eq.5) then
+!       4th order- 5 coeeficients
+       cinterp(1,1:nint)= (/0.d0,-0.5d0, 2.0d0,-2.5d0, 1.d0/)
+       cinterp(2,1:nint)= (/1.d0,0.d0  ,-3.5d0, 3.5d0,-1.d0/)
+       cinterp(3,1:nint)= (/0.d0,0.5d0 ,1.d0  ,0.5d0 ,-1.d0/)
+       cinterp(4,1:nint)= (/0.d0,0.d0  ,0.5d0 ,-1.5d0, 1.d0/)
+    endif
+  end subroutine set_interp_constants
+! =========================================================================
+  subroutine set_tables (itab_in,jtab_in,dxtab_in,dytab_in     &
+       ,xtab_in,ytab_in,etab_in,ptab_in,efer_in) bind(c)
+!   aliases tables loaded and validated by the caller; the caller keeps
+!   ownership and must keep the arrays alive while the eos is in use
+    use iso_c_binding
+    integer(c_int),value :: itab_in,jtab_in
+    real(c_double),value :: dxtab_in,dytab_in
+    type(c_ptr),value :: xtab_in,ytab_in,etab_in,ptab_in,efer_in
+! --------------------------------------------
+    call set_interp_constants
+    itab=itab_in
+    jtab=jtab_in
+    dxtab=dxtab_in
+    dytab=dytab_in
+    call c_f_pointer(xtab_in,xtab,(/itab/))
+    call c_f_pointer(ytab_in,ytab,(/jtab/))
+    call c_f_pointer(etab_in,etab,(/itab,jtab/))
+    call c_f_pointer(ptab_in,ptab,(/itab,jtab/))
+    call c_f_pointer(efer_in,efer,(/itab,jtab/))
+    tmp_min=exp(ytab(1))
+    tmp_max=exp(ytab(jtab))
+  end subroutine set_tables
 end module tables
 ! ========================================================================
 subroutine init_tabular (tab_file)
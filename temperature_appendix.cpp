@@ -1,7 +1,8 @@
 #include "temperature_appendix.hpp"
+#include "safe_retrieve.hpp"
 
-TemperatureAppendix::TemperatureAppendix(const FermiTable& eos):
-  eos_(eos) {}
+TemperatureAppendix::TemperatureAppendix(EosCache& eos_cache):
+  eos_cache_(eos_cache) {}
 
 string TemperatureAppendix::getName(void) const
 {
@@ -11,14 +12,15 @@ string TemperatureAppendix::getName(void) const
 vector<double> TemperatureAppendix::operator()(const hdsim& sim) const
 {
   const vector<ComputationalCell>& cells = sim.getAllCells();
-  vector<double> temperatures(cells.size(),1);
-  for(size_t i=0;i<cells.size();++i){
+  vector<double> res(cells.size(), 1);
+  for(size_t i=0;i<res.size();++i){
     const ComputationalCell& cell = cells[i];
     if(safe_retrieve(cell.stickers,string("ghost")))
       continue;
-    temperatures[i] = eos_.dp2t(cell.density,
-			       cell.pressure,
-			       cell.tracers);
+    res[i] = eos_cache_.dp2state(i,
+				 cell.density,
+				 cell.pressure,
+				 cell.tracers).temperature;
   }
-  return temperatures;
+  return res;
 }
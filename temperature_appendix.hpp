@@ -2,21 +2,20 @@
 #define TEMPERATURE_APPENDIX_HPP 1
 
 #include "source/newtonian/two_dimensional/hdf5_diagnostics.hpp"
-#include "fermi_table.hpp"
-#include "safe_retrieve.hpp"
+#include "eos_cache.hpp"
 
 class TemperatureAppendix: public DiagnosticAppendix
 {
 public:
 
-  TemperatureAppendix(const FermiTable& eos);
+  TemperatureAppendix(EosCache& eos_cache);
 
   string getName(void) const;
 
   vector<double> operator()(const hdsim& sim) const;
 
 private:
-  const FermiTable& eos_;
+  EosCache& eos_cache_;
 };
 
 #endif // TEMPERATURE_APPENDIX_HPP
@@ -0,0 +1,10 @@
+#include <time.h>
+#include "wall_clock.hpp"
+
+double wall_clock(void)
+{
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return static_cast<double>(ts.tv_sec)+
+    1e-9*static_cast<double>(ts.tv_nsec);
+}
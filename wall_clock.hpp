@@ -0,0 +1,7 @@
+#ifndef WALL_CLOCK_HPP
+#define WALL_CLOCK_HPP 1
+
+//! \brief Monotonic wall clock, in seconds since an arbitrary origin
+double wall_clock(void);
+
+#endif // WALL_CLOCK_HPP
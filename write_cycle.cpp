@@ -1,10 +1,22 @@
 #include "write_cycle.hpp"
-#include "source/misc/simple_io.hpp"
+#include "source/misc/vector_initialiser.hpp"
 
-WriteCycle::WriteCycle(const string& fname):
-  fname_(fname) {}
+WriteCycle::WriteCycle(const string& fname, bool binary):
+  sink_(fname, binary) {}
 
 void WriteCycle::operator()(const hdsim& sim)
 {
-  write_number(sim.getCycle(),fname_);
+  sink_.writeRow(VectorInitialiser<double>
+		 (sim.getCycle())
+		 (sim.getTime())());
+}
+
+void WriteCycle::saveState(map<string,double>& state)
+{
+  sink_.saveState(state);
+}
+
+void WriteCycle::loadState(const map<string,double>& state)
+{
+  sink_.loadState(state);
 }
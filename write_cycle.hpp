@@ -2,17 +2,23 @@
 #define WRITE_CYCLE_HPP 1
 
 #include "source/newtonian/test_2d/main_loop_2d.hpp"
+#include "diagnostics_sink.hpp"
 
-class WriteCycle: public DiagnosticFunction
+//! \brief Appends the cycle number and time at every cycle
+class WriteCycle: public DiagnosticFunction, public CheckpointState
 {
 public:
 
-  WriteCycle(const string& fname);
+  explicit WriteCycle(const string& fname, bool binary=false);
 
   void operator()(const hdsim& sim);
 
+  void saveState(map<string,double>& state);
+
+  void loadState(const map<string,double>& state);
+
 private:
-  const string fname_;
+  DiagnosticsSink sink_;
 };
 
 #endif // WRITE_CYCLE_HPP